@@ -0,0 +1,90 @@
+/* Compares the memory held by N elements in a linked_list_t against a compact_list_t.
+ * Build from the repository root with:
+ *   cc -O2 -I. bench/compact_footprint.c linked_list.c compact_list.c -o compact_footprint -lpthread
+ * and run as ./compact_footprint [N]. */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <malloc.h>
+#include <unistd.h>
+#include "linked_list.h"
+#include "compact_list.h"
+
+/* Returns the bytes malloc has handed out, chunk headers and mmap'd blocks included. */
+static size_t heap_in_use(void) {
+	struct mallinfo2 info = mallinfo2();
+
+	return info.uordblks + info.hblkhd;
+}
+
+/* Returns the resident set size of the process in bytes. */
+static size_t resident_bytes(void) {
+	long pages = 0;
+	FILE *statm = fopen("/proc/self/statm", "r");
+
+	if (statm != NULL) {
+		if (fscanf(statm, "%*d %ld", &pages) != 1) {
+			pages = 0;
+		}
+		fclose(statm);
+	}
+
+	return (size_t)pages * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static void report(const char *name, size_t n, size_t heap, size_t rss) {
+	printf("%-14s heap %12zu bytes (%6.2f per element)  rss %12zu bytes (%6.2f per element)\n",
+			name, heap, (double)heap / n, rss, (double)rss / n);
+}
+
+int main(int argc, char **argv) {
+	size_t n = (argc > 1) ? strtoull(argv[1], NULL, 10) : 10000000;
+	size_t i;
+
+	if (n == 0) {
+		return 1;
+	}
+
+	// The payload pointers are never dereferenced, so nothing is allocated for them.
+	size_t heap = heap_in_use();
+	size_t rss = resident_bytes();
+
+	linked_list_t *ll = ll_new();
+	for (i = 0; i < n; i++) {
+		ll_push_tail(ll, (void *)(uintptr_t)(i + 1));
+	}
+
+	report("linked_list_t", n, heap_in_use() - heap, resident_bytes() - rss);
+
+	// Empty the list so destroy does not free the fake payloads.
+	while (ll_size(ll) > 0) {
+		ll_pop_head(ll);
+	}
+	ll_destroy(ll);
+	malloc_trim(0);
+
+	heap = heap_in_use();
+	rss = resident_bytes();
+
+	compact_list_t *cl = cl_new();
+	if (cl == NULL) {
+		return 1;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (!cl_push_tail(cl, (void *)(uintptr_t)(i + 1))) {
+			fprintf(stderr, "compact_list_t arena could not grow past %zu elements\n", i);
+			return 1;
+		}
+	}
+
+	report("compact_list_t", n, heap_in_use() - heap, resident_bytes() - rss);
+
+	while (cl_size(cl) > 0) {
+		cl_pop_head(cl);
+	}
+	cl_destroy(cl);
+
+	return 0;
+}
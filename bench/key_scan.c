@@ -0,0 +1,131 @@
+/* Compares finding and removing elements by a 64-bit id through a compare function
+ * (ll_find and ll_pop_by) against the SIMD key scan of a keyed list (ll_find_key_u64
+ * and ll_pop_by_key). The compare function runs on both a node list and a deque list,
+ * which is laid out like the keyed list, so the deque rows isolate the key scan itself.
+ * Build from the repository root with:
+ *   cc -O2 -I. bench/key_scan.c linked_list.c -o key_scan -lpthread
+ * and run as ./key_scan [N elements] [lookups]. */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include "linked_list.h"
+
+typedef struct {
+	uint64_t id;
+	char payload[56];
+} record_t;
+
+static uint64_t target;
+
+static bool match_target(void *data) {
+	return ((record_t *)data)->id == target;
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, size_t lookups, double seconds) {
+	printf("%-26s %10.1f ns per call\n", name, seconds * 1e9 / lookups);
+}
+
+int main(int argc, char **argv) {
+	size_t n = (argc > 1) ? strtoull(argv[1], NULL, 10) : 10000;
+	size_t lookups = (argc > 2) ? strtoull(argv[2], NULL, 10) : 10000;
+	size_t i;
+
+	if (n == 0 || lookups == 0) {
+		return 1;
+	}
+
+	record_t *records = calloc(n, sizeof(record_t));
+	uint64_t *targets = malloc(lookups * sizeof(uint64_t));
+	linked_list_t *nodes = ll_new();
+	linked_list_t *deque = ll_new_deque();
+	linked_list_t *keyed = ll_new_keyed();
+
+	for (i = 0; i < n; i++) {
+		records[i].id = i * 2654435761u;
+		ll_push_tail(nodes, &records[i]);
+		ll_push_tail(deque, &records[i]);
+		ll_push_tail_key(keyed, &records[i], records[i].id);
+	}
+
+	srand(1);
+	for (i = 0; i < lookups; i++) {
+		targets[i] = records[(size_t)rand() % n].id;
+	}
+
+	// Every list holds the records in the same order, so each lookup stops at the same element on all of them.
+	void *found = NULL;
+	size_t misses = 0;
+	double start = now();
+	for (i = 0; i < lookups; i++) {
+		target = targets[i];
+		misses += (ll_find(nodes, match_target) == NULL);
+	}
+	report("ll_find (nodes)", lookups, now() - start);
+
+	start = now();
+	for (i = 0; i < lookups; i++) {
+		target = targets[i];
+		misses += (ll_find(deque, match_target) == NULL);
+	}
+	report("ll_find (deque)", lookups, now() - start);
+
+	start = now();
+	for (i = 0; i < lookups; i++) {
+		misses += (ll_find_key_u64(keyed, targets[i], &found) != LL_OK);
+	}
+	report("ll_find_key_u64", lookups, now() - start);
+
+	// Popped elements go back on the tail so the list keeps its size.
+	start = now();
+	for (i = 0; i < lookups; i++) {
+		target = targets[i];
+		ll_push_tail(nodes, ll_pop_by(nodes, match_target));
+	}
+	report("ll_pop_by + push (nodes)", lookups, now() - start);
+
+	start = now();
+	for (i = 0; i < lookups; i++) {
+		target = targets[i];
+		ll_push_tail(deque, ll_pop_by(deque, match_target));
+	}
+	report("ll_pop_by + push (deque)", lookups, now() - start);
+
+	start = now();
+	for (i = 0; i < lookups; i++) {
+		misses += (ll_pop_by_key(keyed, targets[i], &found) != LL_OK);
+		ll_push_tail_key(keyed, found, targets[i]);
+	}
+	report("ll_pop_by_key + push_key", lookups, now() - start);
+
+	if (misses != 0) {
+		printf("%zu lookups missed\n", misses);
+	}
+
+	// The records belong to the benchmark, so empty the lists before destroying them.
+	while (ll_size(nodes) > 0) {
+		ll_pop_head(nodes);
+	}
+	while (ll_size(deque) > 0) {
+		ll_pop_head(deque);
+	}
+	while (ll_size(keyed) > 0) {
+		ll_pop_head(keyed);
+	}
+	ll_destroy(nodes);
+	ll_destroy(deque);
+	ll_destroy(keyed);
+	free(targets);
+	free(records);
+
+	return 0;
+}
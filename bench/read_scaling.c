@@ -0,0 +1,126 @@
+/* Measures ll_find throughput as reader threads are added while one writer keeps
+ * rotating the list, for a mutex list (ll_new) and an RCU list (ll_new_rcu).
+ * Build from the repository root with:
+ *   cc -O2 -I. bench/read_scaling.c linked_list.c -o read_scaling -lpthread
+ * and run as ./read_scaling [N elements] [max readers] [milliseconds per run]. */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include "linked_list.h"
+
+typedef struct {
+	linked_list_t *ll;
+	size_t n;
+	unsigned int seed;
+	uint64_t operations;
+} worker_t;
+
+static size_t *values;
+static bool running;
+static _Thread_local size_t target;
+
+static bool match_target(void *data) {
+	return *(size_t *)data == target;
+}
+
+static void *reader(void *arg) {
+	worker_t *worker = (worker_t *)arg;
+
+	while (__atomic_load_n(&running, __ATOMIC_RELAXED)) {
+		target = (size_t)rand_r(&worker->seed) % worker->n;
+		ll_find(worker->ll, match_target);
+		worker->operations++;
+	}
+
+	return NULL;
+}
+
+static void *writer(void *arg) {
+	worker_t *worker = (worker_t *)arg;
+
+	// Move the head to the tail so readers always race with unlinks and pushes.
+	while (__atomic_load_n(&running, __ATOMIC_RELAXED)) {
+		void *data = ll_pop_head(worker->ll);
+		ll_push_tail(worker->ll, data);
+		worker->operations++;
+	}
+
+	return NULL;
+}
+
+static void sleep_ms(long ms) {
+	struct timespec delay = { ms / 1000, (ms % 1000) * 1000000L };
+
+	nanosleep(&delay, NULL);
+}
+
+static void run(const char *name, linked_list_t *(*constructor)(void), size_t n, int readers, long ms) {
+	linked_list_t *ll = constructor();
+	worker_t *workers = calloc((size_t)readers + 1, sizeof(worker_t));
+	pthread_t *threads = calloc((size_t)readers + 1, sizeof(pthread_t));
+	size_t i;
+	int t;
+
+	for (i = 0; i < n; i++) {
+		ll_push_tail(ll, &values[i]);
+	}
+
+	__atomic_store_n(&running, true, __ATOMIC_RELAXED);
+	for (t = 0; t <= readers; t++) {
+		workers[t].ll = ll;
+		workers[t].n = n;
+		workers[t].seed = (unsigned int)t + 1;
+		pthread_create(&threads[t], NULL, (t == 0) ? writer : reader, &workers[t]);
+	}
+
+	sleep_ms(ms);
+	__atomic_store_n(&running, false, __ATOMIC_RELAXED);
+
+	uint64_t lookups = 0;
+	for (t = 0; t <= readers; t++) {
+		pthread_join(threads[t], NULL);
+		if (t > 0) {
+			lookups += workers[t].operations;
+		}
+	}
+
+	printf("%-8s readers %3d  lookups/s %14.0f  writer ops/s %14.0f\n", name, readers,
+			lookups * 1000.0 / ms, workers[0].operations * 1000.0 / ms);
+
+	// The payloads belong to the benchmark, so empty the list before destroying it.
+	while (ll_size(ll) > 0) {
+		ll_pop_head(ll);
+	}
+	ll_destroy(ll);
+	free(threads);
+	free(workers);
+}
+
+int main(int argc, char **argv) {
+	size_t n = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1000;
+	int max_readers = (argc > 2) ? atoi(argv[2]) : 8;
+	long ms = (argc > 3) ? atol(argv[3]) : 1000;
+	size_t i;
+	int readers;
+
+	if (n == 0 || max_readers < 1 || ms < 1) {
+		return 1;
+	}
+
+	values = malloc(n * sizeof(size_t));
+	for (i = 0; i < n; i++) {
+		values[i] = i;
+	}
+
+	for (readers = 1; readers <= max_readers; readers *= 2) {
+		run("mutex", ll_new, n, readers, ms);
+		run("rcu", ll_new_rcu, n, readers, ms);
+	}
+
+	free(values);
+
+	return 0;
+}
@@ -0,0 +1,530 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "compact_list.h"
+
+/* Number of node slots the arena starts with. */
+#define CL_INITIAL_CAPACITY 16
+
+_Static_assert(sizeof(compact_node_t) <= 16, "compact_node_t must stay within 16 bytes");
+
+/* Creates a new empty compact list. Returns NULL if memory runs out. */
+compact_list_t *cl_new(void) {
+	// Allocate memory for compact list management node.
+	compact_list_t *cl = malloc(sizeof(compact_list_t));
+
+	if (cl == NULL) {
+		return NULL;
+	}
+
+	// The arena is allocated on the first push.
+	cl->arena = NULL;
+	cl->capacity = 0;
+	cl->used = 0;
+
+	// There are no released slots yet.
+	cl->free_head = CL_NIL;
+
+	// Head and tail point to nothing.
+	cl->head = CL_NIL;
+	cl->tail = CL_NIL;
+
+	// Allocate memory for mutex.
+	pthread_mutex_t *cl_mutex = malloc(sizeof(pthread_mutex_t));
+
+	// Out of memory, give up on the list.
+	if (cl_mutex == NULL) {
+		free(cl);
+
+		return NULL;
+	}
+
+	// Initialize mutex.
+	pthread_mutex_init(cl_mutex, NULL);
+
+	// Point the structure's lock to the new mutex.
+	cl->lock = (void *)cl_mutex;
+
+	// Initial size is zero.
+	cl->size = 0;
+
+	// Return compact list management node.
+	return cl;
+}
+
+/* Destroys the compact list and all associated data. */
+void cl_destroy(compact_list_t *cl) {
+	// Free every data pointer still on the list.
+	uint32_t i;
+	for (i = cl->head; i != CL_NIL; i = cl->arena[i].next) {
+		free(cl->arena[i].data);
+	}
+
+	// All nodes live in the arena, so a single free releases them.
+	free(cl->arena);
+
+	// Free mutex.
+	pthread_mutex_destroy(cl->lock);
+	free(cl->lock);
+
+	// Free the compact list.
+	free(cl);
+}
+
+/* Returns the size of the compact list. */
+size_t cl_size(compact_list_t *cl) {
+	return cl->size;
+}
+
+/* Hands out a free slot from the arena, growing it when every slot is in use.
+ * Returns CL_NIL if the arena cannot grow. Must be called with the lock held. */
+static uint32_t cl_alloc_node(compact_list_t *cl, void *data) {
+	uint32_t index;
+
+	if (cl->free_head != CL_NIL) {
+		// Reuse the most recently released slot.
+		index = cl->free_head;
+		cl->free_head = cl->arena[index].next;
+	} else {
+		if (cl->used == cl->capacity) {
+			// CL_NIL is reserved, so the arena holds at most CL_NIL slots.
+			if (cl->capacity == CL_NIL) {
+				return CL_NIL;
+			}
+
+			// Double the arena. Slots are addressed by index, so moving it is safe.
+			uint32_t capacity = (cl->capacity == 0) ? CL_INITIAL_CAPACITY :
+				(cl->capacity > CL_NIL / 2) ? CL_NIL : cl->capacity * 2;
+			compact_node_t *arena = realloc(cl->arena, (size_t)capacity * sizeof(compact_node_t));
+
+			if (arena == NULL) {
+				return CL_NIL;
+			}
+
+			cl->arena = arena;
+			cl->capacity = capacity;
+		}
+
+		// Take the next never-used slot.
+		index = cl->used++;
+	}
+
+	// Point the node at the provided data.
+	cl->arena[index].data = data;
+	cl->arena[index].next = CL_NIL;
+	cl->arena[index].prev = CL_NIL;
+
+	return index;
+}
+
+/* Returns a slot to the arena's free chain. Must be called with the lock held. */
+static void cl_free_node(compact_list_t *cl, uint32_t index) {
+	cl->arena[index].data = NULL;
+	cl->arena[index].next = cl->free_head;
+	cl->free_head = index;
+}
+
+/* Links a new node in front of the node at next_index, or at the tail if next_index is CL_NIL.
+ * Returns false if the arena cannot grow. Must be called with the lock held. */
+static bool cl_link_before(compact_list_t *cl, uint32_t next_index, void *data) {
+	// Make a new node.
+	uint32_t new_index = cl_alloc_node(cl, data);
+
+	// Out of memory, leave the list untouched.
+	if (new_index == CL_NIL) {
+		return false;
+	}
+
+	compact_node_t *arena = cl->arena;
+
+	// The new node sits between the previous node and next_index.
+	uint32_t prev_index = (next_index == CL_NIL) ? cl->tail : arena[next_index].prev;
+
+	arena[new_index].next = next_index;
+	arena[new_index].prev = prev_index;
+
+	// Point the previous node (or the head) at the new node.
+	if (prev_index == CL_NIL) {
+		cl->head = new_index;
+	} else {
+		arena[prev_index].next = new_index;
+	}
+
+	// Point the next node (or the tail) back at the new node.
+	if (next_index == CL_NIL) {
+		cl->tail = new_index;
+	} else {
+		arena[next_index].prev = new_index;
+	}
+
+	// Increase the size.
+	cl->size++;
+
+	return true;
+}
+
+/* Removes the node at index from the list, releases its slot and returns its data.
+ * Must be called with the lock held. */
+static void *cl_unlink(compact_list_t *cl, uint32_t index) {
+	compact_node_t *arena = cl->arena;
+
+	// Grab the data before doing anything with the node.
+	void *data = arena[index].data;
+
+	// The previous node (or the head) now points to the node's next node.
+	if (arena[index].prev == CL_NIL) {
+		cl->head = arena[index].next;
+	} else {
+		arena[arena[index].prev].next = arena[index].next;
+	}
+
+	// The next node (or the tail) now points to the node's previous node.
+	if (arena[index].next == CL_NIL) {
+		cl->tail = arena[index].prev;
+	} else {
+		arena[arena[index].next].prev = arena[index].prev;
+	}
+
+	// Now that the node is out of the list, release the slot.
+	cl_free_node(cl, index);
+
+	// Decrease the size.
+	cl->size--;
+
+	return data;
+}
+
+/* Finds the node at the given index, where a negative index counts back from the tail (-1 is the tail).
+ * Returns CL_NIL if the index is out of range. Must be called with the lock held. */
+static uint32_t cl_node_at(compact_list_t *cl, int index) {
+	// Resolve negative indexing against the size of the list.
+	long long position = (index < 0) ? (long long)cl->size + index : index;
+
+	if (position < 0 || position >= (long long)cl->size) {
+		return CL_NIL;
+	}
+
+	uint32_t current;
+
+	if (position < (long long)cl->size / 2) {
+		// Walk forward from the head.
+		current = cl->head;
+		for (; position > 0; position--) {
+			current = cl->arena[current].next;
+		}
+	} else {
+		// Walk backwards from the tail.
+		current = cl->tail;
+		for (position = (long long)cl->size - 1 - position; position > 0; position--) {
+			current = cl->arena[current].prev;
+		}
+	}
+
+	return current;
+}
+
+/* Finds the first node whose data satisfies compare_function, or CL_NIL. Must be called with the lock held. */
+static uint32_t cl_find(compact_list_t *cl, bool (*compare_function)(void *cmd_data)) {
+	uint32_t current;
+
+	for (current = cl->head; current != CL_NIL; current = cl->arena[current].next) {
+		if (compare_function(cl->arena[current].data)) {
+			return current;
+		}
+	}
+
+	return CL_NIL;
+}
+
+/* Sorts the chain starting at head by its next links with a bottom-up merge sort and returns the new head.
+ * Runs of width 1, 2, 4, ... are merged pairwise in place, so the sort takes O(n log n) comparisons on any input,
+ * needs no recursion and allocates nothing. Equal elements keep their order. prev links are left stale. */
+static uint32_t cl_merge_sort(compact_node_t *arena, uint32_t head, int (*compare_function)(void *first_data, void *second_data)) {
+	size_t width = 1;
+
+	for (;;) {
+		uint32_t left = head;
+		uint32_t tail = CL_NIL;
+		size_t merges = 0;
+
+		head = CL_NIL;
+
+		while (left != CL_NIL) {
+			merges++;
+
+			// The right run starts width nodes after the left one.
+			uint32_t right = left;
+			size_t left_size = 0;
+			while (left_size < width && right != CL_NIL) {
+				left_size++;
+				right = arena[right].next;
+			}
+			size_t right_size = width;
+
+			// Merge the two runs onto the tail of the output chain.
+			while (left_size > 0 || (right_size > 0 && right != CL_NIL)) {
+				uint32_t next;
+
+				if (left_size == 0) {
+					next = right;
+					right = arena[right].next;
+					right_size--;
+				} else if (right_size == 0 || right == CL_NIL || compare_function(arena[left].data, arena[right].data) <= 0) {
+					next = left;
+					left = arena[left].next;
+					left_size--;
+				} else {
+					next = right;
+					right = arena[right].next;
+					right_size--;
+				}
+
+				if (tail == CL_NIL) {
+					head = next;
+				} else {
+					arena[tail].next = next;
+				}
+				tail = next;
+			}
+
+			// The next pair of runs starts where the right run ended.
+			left = right;
+		}
+
+		arena[tail].next = CL_NIL;
+
+		// A single merge means the whole chain is one sorted run.
+		if (merges <= 1) {
+			return head;
+		}
+
+		width *= 2;
+	}
+}
+
+void cl_sort(compact_list_t *cl, int (*compare_function)(void *first_data, void *second_data)) {
+	// Lock the compact list while being sorted.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	// Sort the compact list.
+	if (cl->size > 1) {
+		cl->head = cl_merge_sort(cl->arena, cl->head, compare_function);
+
+		// Rebuild the prev links and the tail from the sorted next links.
+		uint32_t prev = CL_NIL;
+		uint32_t current;
+		for (current = cl->head; current != CL_NIL; current = cl->arena[current].next) {
+			cl->arena[current].prev = prev;
+			prev = current;
+		}
+
+		cl->tail = prev;
+	}
+
+	// Unlock the compact list now that the list is sorted.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+}
+
+/* Push data onto the tail of the provided compact list and adjust the tail.
+ * Returns false if the arena cannot grow, in which case the data still belongs to the caller. */
+bool cl_push_tail(compact_list_t *cl, void *data) {
+	// Lock the compact list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	// Link the new node after the current tail.
+	bool pushed = cl_link_before(cl, CL_NIL, data);
+
+	// Unlock the compact list.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+
+	return pushed;
+}
+
+/* Push data onto the head of the provided compact list and adjust the head. Returns false as cl_push_tail does. */
+bool cl_push_head(compact_list_t *cl, void *data) {
+	// Lock the compact list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	// Link the new node in front of the current head.
+	bool pushed = cl_link_before(cl, cl->head, data);
+
+	// Unlock the compact list.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+
+	return pushed;
+}
+
+/* Push data into the list after the element found by using the provided compare function.
+ * If no element matches, the data is pushed onto the tail. Returns false as cl_push_tail does. */
+bool cl_push_after(compact_list_t *cl, void *data, bool (*compare_function)(void *cmd_data)) {
+	// Lock the compact list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	// Find the node to push after.
+	uint32_t current = cl_find(cl, compare_function);
+
+	// Link in front of the found node's next node, or at the tail if not found.
+	bool pushed = cl_link_before(cl, (current == CL_NIL) ? CL_NIL : cl->arena[current].next, data);
+
+	// Unlock the compact list.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+
+	return pushed;
+}
+
+/* Push data into the list before the element found by using the provided compare function.
+ * If no element matches, the data is pushed onto the head. Returns false as cl_push_tail does. */
+bool cl_push_before(compact_list_t *cl, void *data, bool (*compare_function)(void *cmd_data)) {
+	// Lock the compact list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	// Find the node to push before.
+	uint32_t current = cl_find(cl, compare_function);
+
+	// Link in front of the found node, or at the head if not found.
+	bool pushed = cl_link_before(cl, (current == CL_NIL) ? cl->head : current, data);
+
+	// Unlock the compact list.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+
+	return pushed;
+}
+
+/* Push data into the list at the specified index assuming a 0 indexed list.
+ * This will shift the element at the specified index to be after the inserted node.
+ * An index equal to or past the size pushes onto the tail. Returns false as cl_push_tail does. */
+bool cl_push_at_index(compact_list_t *cl, void *data, int index) {
+	// Lock the compact list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	uint32_t current;
+
+	if (index >= 0 && (size_t)index >= cl->size) {
+		// Past the end of the list, push as the tail.
+		current = CL_NIL;
+	} else {
+		// Find the node currently at the index, falling back to the head if out of range.
+		current = cl_node_at(cl, index);
+		if (current == CL_NIL) {
+			current = cl->head;
+		}
+	}
+
+	// Link in front of the node at the index.
+	bool pushed = cl_link_before(cl, current, data);
+
+	// Unlock the compact list.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+
+	return pushed;
+}
+
+/* Remove the head of the provided compact list and adjust the head. */
+void *cl_pop_head(compact_list_t *cl) {
+	// Lock the compact list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	// If the compact list is empty, return null.
+	void *data = (cl->size == 0) ? NULL : cl_unlink(cl, cl->head);
+
+	// Unlock the compact list.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+
+	// Return the data.
+	return data;
+}
+
+/* Remove the tail of the provided compact list and adjust the tail. */
+void *cl_pop_tail(compact_list_t *cl) {
+	// Lock the compact list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	// If the compact list is empty, return null.
+	void *data = (cl->size == 0) ? NULL : cl_unlink(cl, cl->tail);
+
+	// Unlock the compact list.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+
+	// Return the data.
+	return data;
+}
+
+/* Iterate through the list from head to find the requested node using the provided compare function. */
+void *cl_pop_by(compact_list_t *cl, bool (*compare_function)(void *cmd_data)) {
+	// Lock the compact list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	// Find the requested node.
+	uint32_t current = cl_find(cl, compare_function);
+
+	// Node wasn't found in the list.
+	void *data = (current == CL_NIL) ? NULL : cl_unlink(cl, current);
+
+	// Unlock the compact list.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+
+	// Return the data.
+	return data;
+}
+
+/* Remove the node at the specified index. A negative number traverses the list from the tail (-1 indexed). */
+void *cl_pop_by_index(compact_list_t *cl, int index) {
+	// Lock the compact list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	// Find the node at the index.
+	uint32_t current = cl_node_at(cl, index);
+
+	// If the index is beyond the size of the compact list, return null.
+	void *data = (current == CL_NIL) ? NULL : cl_unlink(cl, current);
+
+	// Unlock the compact list.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+
+	// Return the data.
+	return data;
+}
+
+/* Prints the information about all nodes in the compact list. Useful for debug information. */
+static void cl_print_list_base(compact_list_t *cl, bool reversed) {
+	// Lock the compact list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)cl->lock);
+
+	// Point at the head (or tail if reversed) of the compact list.
+	uint32_t current = (reversed) ? cl->tail : cl->head;
+
+	// Integer to track of which node we are on.
+	int index = (reversed) ? cl->size - 1 : 0;
+
+	// While we are still within the list.
+	while (current != CL_NIL) {
+
+		// Print a table describing the slots. CL_NIL prints as -1.
+		printf(	"Node %d:\n"					// Print the index of the node we are at.
+				"\tPrevious: %d\n"				// Print the slot of the previous node.
+				"\tSlot: %d\n"					// Print the slot of the node.
+				"\tData: %p\n"					// Print the address of the pointer to the data.
+				"\tNext: %d\n",					// Print the slot of the next node.
+				(reversed) ? index-- : index++,	// Increment (or decrement if reversed) the index after using.
+				(int)cl->arena[current].prev,
+				(int)current,
+				(void *)cl->arena[current].data,
+				(int)cl->arena[current].next
+			);
+
+		// Point to the next (or previous if reversed) node in the list.
+		current = (reversed) ? cl->arena[current].prev : cl->arena[current].next;
+	}
+
+	// Unlock the compact list.
+	pthread_mutex_unlock((pthread_mutex_t *)cl->lock);
+}
+
+/* Variation function to allow for a singular or secondary parameter to reverse the print of the list. */
+void var_cl_print_list(cl_print_list_args args) {
+	// Run the base function, reversed defaults to false when not provided.
+	cl_print_list_base(args.cl, args.reversed);
+}
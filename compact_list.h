@@ -0,0 +1,48 @@
+#ifndef __COMPACT_LIST_H__
+#define __COMPACT_LIST_H__
+
+/* Index used in place of a NULL pointer. */
+#define CL_NIL UINT32_MAX
+
+/* Nodes live in the list's arena and link to each other by their 32-bit slot index,
+ * so each node is 16 bytes on a 64-bit target and carries no allocator header. */
+typedef struct compact_node {
+	void *data;
+	uint32_t next;
+	uint32_t prev;
+} compact_node_t;
+
+typedef struct compact_list {
+	compact_node_t *arena;
+	uint32_t capacity;
+	uint32_t used;
+	uint32_t free_head;
+	uint32_t head;
+	uint32_t tail;
+	size_t size;
+	void *lock;
+} compact_list_t;
+
+typedef struct {
+	compact_list_t *cl;
+	bool reversed;
+} cl_print_list_args;
+
+compact_list_t *cl_new(void);
+void cl_destroy(compact_list_t *cl);
+size_t cl_size(compact_list_t *cl);
+void cl_sort(compact_list_t *cl, int (*compare_function)(void *first_data, void *second_data));
+bool cl_push_tail(compact_list_t *cl, void *data);
+bool cl_push_head(compact_list_t *cl, void *data);
+bool cl_push_after(compact_list_t *cl, void *data, bool (*compare_function)(void *cmd_data));
+bool cl_push_before(compact_list_t *cl, void *data, bool (*compare_function)(void *cmd_data));
+bool cl_push_at_index(compact_list_t *cl, void *data, int index);
+void *cl_pop_head(compact_list_t *cl);
+void *cl_pop_tail(compact_list_t *cl);
+void *cl_pop_by(compact_list_t *cl, bool (*compare_function)(void *cmd_data));
+void *cl_pop_by_index(compact_list_t *cl, int index);
+
+#define cl_print_list(...) var_cl_print_list((cl_print_list_args){__VA_ARGS__});
+void var_cl_print_list(cl_print_list_args args);
+
+#endif //__COMPACT_LIST_H__
@@ -4,22 +4,252 @@
 #include <stdbool.h>
 #include <string.h>
 #include <pthread.h>
+#include <sched.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 #include "linked_list.h"
 
+/* Stores a link, or the data of a linked node, that lock-free readers may follow in RCU mode. The release
+ * ordering makes sure a reader that sees the new pointer also sees the node it points at. */
+#define LL_PUBLISH(link, node) __atomic_store_n(&(link), (node), __ATOMIC_RELEASE)
+
+/* Loads a link stored with LL_PUBLISH. */
+#define LL_FOLLOW(link) __atomic_load_n(&(link), __ATOMIC_ACQUIRE)
+
+/* Hints the CPU to start fetching a node a scan will reach soon. Prefetching NULL is harmless. */
+#define LL_PREFETCH(address) __builtin_prefetch(address)
+
+/* Number of readers that can be inside a read-side critical section at once. */
+#define LL_EPOCH_SLOTS 64
+
+/* Retired nodes are reclaimed once this many are waiting. */
+#define LL_EPOCH_BATCH 64
+
+/* A node that has been unlinked but may still be visible to a reader. Data is set when the
+ * list dropped the element itself and must be freed along with the node, and NULL otherwise. */
+typedef struct {
+	node_t *node;
+	void *data;
+	unsigned long epoch;
+} ll_retired_t;
+
+/* Epoch-based reclamation state for a list in RCU mode. A reader slot holds
+ * (epoch << 1) | 1 while the reader is active and 0 otherwise. */
+typedef struct {
+	unsigned long global;
+	unsigned long slots[LL_EPOCH_SLOTS];
+	ll_retired_t *limbo;
+	size_t limbo_size;
+	size_t limbo_capacity;
+} ll_epoch_t;
+
+/* Block of nodes laid out in list order by ll_compact. Nodes from the block are
+ * recycled through free_list instead of being passed to free. */
+typedef struct {
+	node_t *block;
+	size_t capacity;
+	node_t *free_list;
+} ll_pool_t;
+
+/* Limits on a list, along with the bytes of individually allocated nodes counted against them.
+ * A limit of 0 means unlimited. */
+typedef struct {
+	size_t max_size;
+	size_t max_bytes;
+	ll_overflow_t policy;
+	size_t node_bytes;
+} ll_budget_t;
+
+/* Returns true if the node was carved out of the list's pooled block. */
+static bool ll_pool_owns(ll_pool_t *pool, node_t *node) {
+	return pool != NULL && node >= pool->block && node < pool->block + pool->capacity;
+}
+
+/* Makes a new node, reusing a pooled node when one is free. Must be called with the lock held. */
+static node_t *ll_alloc_node(linked_list_t *ll) {
+	ll_pool_t *pool = (ll_pool_t *)ll->pool;
+
+	// Take the most recently released pooled node.
+	if (pool != NULL && pool->free_list != NULL) {
+		node_t *node = pool->free_list;
+		pool->free_list = node->next;
+
+		return node;
+	}
+
+	node_t *node = malloc(sizeof(node_t));
+
+	// Count the node towards the list's memory usage.
+	if (node != NULL) {
+		((ll_budget_t *)ll->budget)->node_bytes += sizeof(node_t);
+	}
+
+	return node;
+}
+
+/* Releases a node no reader can reach, handing pooled nodes back to the pool. Must be called with the lock held. */
+static void ll_free_node(linked_list_t *ll, node_t *node) {
+	ll_pool_t *pool = (ll_pool_t *)ll->pool;
+
+	if (ll_pool_owns(pool, node)) {
+		node->next = pool->free_list;
+		pool->free_list = node;
+
+		return;
+	}
+
+	((ll_budget_t *)ll->budget)->node_bytes -= sizeof(node_t);
+	free(node);
+}
+
+/* Advances the global epoch if every active reader has observed it, then frees the
+ * retired nodes no reader can still reach. Must be called with the writer lock held. */
+static void ll_epoch_reclaim(linked_list_t *ll) {
+	ll_epoch_t *epoch = (ll_epoch_t *)ll->epoch;
+
+	unsigned long global = __atomic_load_n(&epoch->global, __ATOMIC_SEQ_CST);
+
+	// The epoch can only move on once no reader is still in an older one.
+	bool quiescent = true;
+	int i;
+	for (i = 0; i < LL_EPOCH_SLOTS; i++) {
+		unsigned long slot = __atomic_load_n(&epoch->slots[i], __ATOMIC_SEQ_CST);
+
+		if ((slot & 1) && (slot >> 1) != global) {
+			quiescent = false;
+			break;
+		}
+	}
+
+	if (quiescent) {
+		global++;
+		__atomic_store_n(&epoch->global, global, __ATOMIC_SEQ_CST);
+	}
+
+	// A node retired two epochs ago can no longer be held by any reader.
+	size_t kept = 0;
+	size_t j;
+	for (j = 0; j < epoch->limbo_size; j++) {
+		if (epoch->limbo[j].epoch + 2 <= global) {
+			free(epoch->limbo[j].data);
+			ll_free_node(ll, epoch->limbo[j].node);
+		} else {
+			epoch->limbo[kept++] = epoch->limbo[j];
+		}
+	}
+
+	epoch->limbo_size = kept;
+}
+
+/* Releases a node that has just been unlinked, along with its data if data is not NULL. In RCU mode
+ * both are kept until every reader that could have seen them has left its critical section.
+ * Must be called with the lock held. */
+static void ll_retire(linked_list_t *ll, node_t *node, void *data) {
+	ll_epoch_t *epoch = (ll_epoch_t *)ll->epoch;
+
+	// Without concurrent readers the node can go immediately.
+	if (epoch == NULL) {
+		free(data);
+		ll_free_node(ll, node);
+		return;
+	}
+
+	// Make room for the node, waiting for readers to drain if the limbo cannot grow.
+	while (epoch->limbo_size == epoch->limbo_capacity) {
+		ll_retired_t *limbo = realloc(epoch->limbo, epoch->limbo_capacity * 2 * sizeof(ll_retired_t));
+
+		if (limbo != NULL) {
+			epoch->limbo = limbo;
+			epoch->limbo_capacity *= 2;
+		} else {
+			ll_epoch_reclaim(ll);
+			sched_yield();
+		}
+	}
+
+	// The unlink stores must be visible before the global epoch is sampled. Without the fence
+	// the epoch load can be reordered ahead of them (store-load reordering, allowed even on x86),
+	// tagging the node with an epoch older than the one it was unlinked in. A reader that enters
+	// the next epoch could then still reach the node after ll_epoch_reclaim has moved two epochs
+	// past the tag and freed it.
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	// Tag the node with the epoch it was unlinked in.
+	epoch->limbo[epoch->limbo_size].node = node;
+	epoch->limbo[epoch->limbo_size].data = data;
+	epoch->limbo[epoch->limbo_size].epoch = __atomic_load_n(&epoch->global, __ATOMIC_SEQ_CST);
+	epoch->limbo_size++;
+
+	// Reclaim in batches to keep the slot scan off the common path.
+	if (epoch->limbo_size >= LL_EPOCH_BATCH) {
+		ll_epoch_reclaim(ll);
+	}
+}
+
+/* Releases a node that has just been unlinked, leaving its data to the caller. Must be called with the lock held. */
+static void ll_retire_node(linked_list_t *ll, node_t *node) {
+	ll_retire(ll, node, NULL);
+}
+
+/* Waits until every reader that was active when called has left its critical section,
+ * then frees every retired node. Must be called with the writer lock held. */
+static void ll_epoch_synchronize(linked_list_t *ll) {
+	ll_epoch_t *epoch = (ll_epoch_t *)ll->epoch;
+
+	// Readers announcing the new epoch started after everything unlinked so far.
+	unsigned long target = __atomic_add_fetch(&epoch->global, 1, __ATOMIC_SEQ_CST);
+
+	// Wait for every reader still in an older epoch.
+	int i;
+	for (i = 0; i < LL_EPOCH_SLOTS; i++) {
+		for (;;) {
+			unsigned long slot = __atomic_load_n(&epoch->slots[i], __ATOMIC_SEQ_CST);
+
+			if (!(slot & 1) || (slot >> 1) >= target) {
+				break;
+			}
+
+			sched_yield();
+		}
+	}
+
+	// No reader can hold a retired node anymore.
+	size_t j;
+	for (j = 0; j < epoch->limbo_size; j++) {
+		free(epoch->limbo[j].data);
+		ll_free_node(ll, epoch->limbo[j].node);
+	}
+
+	epoch->limbo_size = 0;
+}
+
 /* Creates a new empty linked list. */
 linked_list_t *ll_new(void) {
 	// Allocate memory for linked list management node.
 	linked_list_t *ll = malloc(sizeof(linked_list_t));
 
+	// Allocate memory for mutex.
+	pthread_mutex_t *ll_mutex = malloc(sizeof(pthread_mutex_t));
+
+	// Allocate the budget, with no limits set.
+	ll_budget_t *budget = calloc(1, sizeof(ll_budget_t));
+
+	// Out of memory, give up on the list.
+	if (ll == NULL || ll_mutex == NULL || budget == NULL) {
+		free(ll);
+		free(ll_mutex);
+		free(budget);
+
+		return NULL;
+	}
+
 	// Head points to null.
 	ll->head = NULL;
 
 	// Tail points to null.
 	ll->tail = NULL;
 
-	// Allocate memory for mutex.
-	pthread_mutex_t *ll_mutex = malloc(sizeof(pthread_mutex_t));
-
 	// Initialize mutex.
 	pthread_mutex_init(ll_mutex, NULL);
 
@@ -29,6 +259,483 @@ linked_list_t *ll_new(void) {
 	// Initial size is zero.
 	ll->size = 0;
 
+	// Point the structure's budget at the limits.
+	ll->budget = (void *)budget;
+
+	// Readers take the mutex unless the list is created in RCU mode.
+	ll->epoch = NULL;
+
+	// Nodes are allocated individually until the list is compacted.
+	ll->pool = NULL;
+
+	// Elements live in nodes unless the list is created as a deque.
+	ll->deque = NULL;
+
+	// Return linked list management node.
+	return ll;
+}
+
+/* Creates a new empty linked list in RCU mode, where readers traverse without taking the lock. */
+linked_list_t *ll_new_rcu(void) {
+	// Start from a regular linked list.
+	linked_list_t *ll = ll_new();
+
+	if (ll == NULL) {
+		return NULL;
+	}
+
+	// Allocate the epoch state, with every reader slot inactive.
+	ll_epoch_t *epoch = calloc(1, sizeof(ll_epoch_t));
+
+	if (epoch == NULL) {
+		ll_destroy(ll);
+
+		return NULL;
+	}
+
+	// Epoch 0 is never used so a slot of 0 always means inactive.
+	epoch->global = 1;
+
+	// Allocate room for one batch of retired nodes up front.
+	epoch->limbo_capacity = LL_EPOCH_BATCH;
+	epoch->limbo = malloc(epoch->limbo_capacity * sizeof(ll_retired_t));
+
+	// Point the structure's epoch at the new state.
+	ll->epoch = (void *)epoch;
+
+	// Out of memory, give up on the list.
+	if (epoch->limbo == NULL) {
+		ll_destroy(ll);
+
+		return NULL;
+	}
+
+	// Return linked list management node.
+	return ll;
+}
+
+/* Number of slots a deque list starts with. Capacities are always powers of two. */
+#define LL_DEQUE_INITIAL_CAPACITY 16
+
+/* Ring buffer holding the data pointers of a deque list. Element i of the list
+ * lives at items[(start + i) & (capacity - 1)]. Keyed lists keep each element's
+ * 64-bit key at the same position in keys, which is NULL otherwise. */
+typedef struct {
+	void **items;
+	uint64_t *keys;
+	size_t capacity;
+	size_t start;
+} ll_deque_t;
+
+/* Returns the buffer position of element index. */
+static size_t ll_deque_position(ll_deque_t *deque, size_t index) {
+	return (deque->start + index) & (deque->capacity - 1);
+}
+
+/* Moves the ring into a new buffer of the given capacity with element 0 at the front.
+ * Returns false if the buffer cannot be allocated. Must be called with the lock held. */
+static bool ll_deque_resize(linked_list_t *ll, size_t capacity) {
+	ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+	void **items = malloc(capacity * sizeof(void *));
+	uint64_t *keys = (deque->keys != NULL) ? malloc(capacity * sizeof(uint64_t)) : NULL;
+
+	if (items == NULL || (deque->keys != NULL && keys == NULL)) {
+		free(items);
+		free(keys);
+
+		return false;
+	}
+
+	// Copy the part up to the end of the buffer, then the part that wrapped around.
+	size_t first = deque->capacity - deque->start;
+	if (first > ll->size) {
+		first = ll->size;
+	}
+
+	memcpy(items, deque->items + deque->start, first * sizeof(void *));
+	memcpy(items + first, deque->items, (ll->size - first) * sizeof(void *));
+
+	// Keys move along with their data.
+	if (keys != NULL) {
+		memcpy(keys, deque->keys + deque->start, first * sizeof(uint64_t));
+		memcpy(keys + first, deque->keys, (ll->size - first) * sizeof(uint64_t));
+	}
+
+	free(deque->items);
+	free(deque->keys);
+
+	deque->items = items;
+	deque->keys = keys;
+	deque->capacity = capacity;
+	deque->start = 0;
+
+	return true;
+}
+
+/* Moves count elements from index from to index to, one memmove per stretch that does not wrap.
+ * The ranges may overlap. Must be called with the lock held. */
+static void ll_deque_move(ll_deque_t *deque, size_t to, size_t from, size_t count) {
+	if (to < from) {
+		// Moving towards the front, so copy front to back.
+		size_t i = 0;
+		while (i < count) {
+			size_t source = ll_deque_position(deque, from + i);
+			size_t destination = ll_deque_position(deque, to + i);
+
+			// Stop the stretch where either side wraps.
+			size_t n = count - i;
+			if (n > deque->capacity - source) {
+				n = deque->capacity - source;
+			}
+			if (n > deque->capacity - destination) {
+				n = deque->capacity - destination;
+			}
+
+			memmove(deque->items + destination, deque->items + source, n * sizeof(void *));
+			if (deque->keys != NULL) {
+				memmove(deque->keys + destination, deque->keys + source, n * sizeof(uint64_t));
+			}
+			i += n;
+		}
+	} else {
+		// Moving towards the back, so copy back to front.
+		size_t i = count;
+		while (i > 0) {
+			size_t source_end = ll_deque_position(deque, from + i - 1) + 1;
+			size_t destination_end = ll_deque_position(deque, to + i - 1) + 1;
+
+			// Stop the stretch where either side wraps.
+			size_t n = i;
+			if (n > source_end) {
+				n = source_end;
+			}
+			if (n > destination_end) {
+				n = destination_end;
+			}
+
+			memmove(deque->items + destination_end - n, deque->items + source_end - n, n * sizeof(void *));
+			if (deque->keys != NULL) {
+				memmove(deque->keys + destination_end - n, deque->keys + source_end - n, n * sizeof(uint64_t));
+			}
+			i -= n;
+		}
+	}
+}
+
+/* Inserts data so that it becomes element index, shifting whichever side of the ring is shorter.
+ * The key is only stored on keyed lists. Returns false if the ring cannot grow. Must be called with the lock held. */
+static bool ll_deque_insert(linked_list_t *ll, size_t index, void *data, uint64_t key) {
+	ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+	// Grow the ring when it is full, leaving the list untouched if that fails.
+	if (ll->size == deque->capacity && !ll_deque_resize(ll, deque->capacity * 2)) {
+		return false;
+	}
+
+	if (index < ll->size / 2) {
+		// Open a slot at the front and shift the elements before index into it.
+		deque->start = (deque->start - 1) & (deque->capacity - 1);
+		ll_deque_move(deque, 0, 1, index);
+	} else {
+		// Shift the elements from index onwards back by one.
+		ll_deque_move(deque, index + 1, index, ll->size - index);
+	}
+
+	deque->items[ll_deque_position(deque, index)] = data;
+	if (deque->keys != NULL) {
+		deque->keys[ll_deque_position(deque, index)] = key;
+	}
+
+	// Increase the size.
+	ll->size++;
+
+	return true;
+}
+
+/* Removes element index and returns its data, closing the gap from whichever side is shorter.
+ * Must be called with the lock held. */
+static void *ll_deque_remove(linked_list_t *ll, size_t index) {
+	ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+	// Grab the data before doing anything with the ring.
+	void *data = deque->items[ll_deque_position(deque, index)];
+
+	if (index < ll->size / 2) {
+		// Shift the elements before index back by one and drop the front slot.
+		ll_deque_move(deque, 1, 0, index);
+		deque->start = (deque->start + 1) & (deque->capacity - 1);
+	} else {
+		// Shift the elements after index forward by one.
+		ll_deque_move(deque, index, index + 1, ll->size - index - 1);
+	}
+
+	// Decrease the size.
+	ll->size--;
+
+	return data;
+}
+
+/* Returns the index of the first element the compare function returns true for, or the size if none does.
+ * Must be called with the lock held. */
+static size_t ll_deque_find(linked_list_t *ll, bool (*compare_function)(void *cmd_data)) {
+	ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+	size_t i;
+	for (i = 0; i < ll->size; i++) {
+		if (compare_function(deque->items[ll_deque_position(deque, i)])) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+/* Returns where ll_push_after puts new data: after the element found, or at the tail if none matches.
+ * Must be called with the lock held. */
+static size_t ll_deque_index_after(linked_list_t *ll, bool (*compare_function)(void *cmd_data)) {
+	size_t index = ll_deque_find(ll, compare_function);
+
+	return (index == ll->size) ? index : index + 1;
+}
+
+/* Returns where ll_push_before puts new data: before the element found, or at the head if none matches.
+ * Must be called with the lock held. */
+static size_t ll_deque_index_before(linked_list_t *ll, bool (*compare_function)(void *cmd_data)) {
+	size_t index = ll_deque_find(ll, compare_function);
+
+	return (index == ll->size) ? 0 : index;
+}
+
+/* Returns where ll_push_at_index puts new data. A negative index pushes before the element counted
+ * back from the tail, and indexes past either end are clamped. Must be called with the lock held. */
+static size_t ll_deque_index_at(linked_list_t *ll, int index) {
+	long long position = (index < 0) ? (long long)ll->size + index : index;
+
+	if (position < 0) {
+		return 0;
+	}
+
+	if (position > (long long)ll->size) {
+		return ll->size;
+	}
+
+	return (size_t)position;
+}
+
+/* Swaps elements i and j of an array, along with their keys if there are any. */
+static void ll_array_swap(void **items, uint64_t *keys, size_t i, size_t j) {
+	void *t = items[i];
+	items[i] = items[j];
+	items[j] = t;
+
+	if (keys != NULL) {
+		uint64_t k = keys[i];
+		keys[i] = keys[j];
+		keys[j] = k;
+	}
+}
+
+/* Reverses items (and keys) from index from up to, but not including, index to. */
+static void ll_array_reverse(void **items, uint64_t *keys, size_t from, size_t to) {
+	while (from + 1 < to) {
+		ll_array_swap(items, keys, from++, --to);
+	}
+}
+
+/* Rotates the whole ring in place so element 0 sits at the start of the buffer, with three reversals
+ * instead of a second buffer. Must be called with the lock held. */
+static void ll_deque_rotate_to_front(ll_deque_t *deque) {
+	ll_array_reverse(deque->items, deque->keys, 0, deque->start);
+	ll_array_reverse(deque->items, deque->keys, deque->start, deque->capacity);
+	ll_array_reverse(deque->items, deque->keys, 0, deque->capacity);
+	deque->start = 0;
+}
+
+static void ll_array_quick_sort(void **items, uint64_t *keys, size_t count, int (*compare_function)(void *first_data, void *second_data)) {
+	// Lists of one element or none are already sorted.
+	while (count > 1) {
+		// Partition around the last element.
+		void *pivot = items[count - 1];
+		size_t i = 0;
+		size_t j;
+
+		for (j = 0; j < count - 1; j++) {
+			if (compare_function(items[j], pivot) < 0) {
+				ll_array_swap(items, keys, i, j);
+				i++;
+			}
+		}
+
+		ll_array_swap(items, keys, i, count - 1);
+
+		// Recurse into the smaller side and loop on the larger one to bound the stack depth.
+		if (i < count - i - 1) {
+			ll_array_quick_sort(items, keys, i, compare_function);
+			items += i + 1;
+			keys = (keys != NULL) ? keys + i + 1 : NULL;
+			count -= i + 1;
+		} else {
+			ll_array_quick_sort(items + i + 1, (keys != NULL) ? keys + i + 1 : NULL, count - i - 1, compare_function);
+			count = i;
+		}
+	}
+}
+
+/* Returns the index of the first of count keys equal to key, or count if there is none. */
+static size_t ll_key_scan_scalar(const uint64_t *keys, size_t count, uint64_t key) {
+	size_t i;
+	for (i = 0; i < count; i++) {
+		if (keys[i] == key) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+#if defined(__x86_64__)
+/* SSE2 version of ll_key_scan_scalar, comparing two keys at a time. SSE2 has no 64-bit
+ * compare, so both 32-bit halves are compared and the results combined. */
+static size_t ll_key_scan_sse2(const uint64_t *keys, size_t count, uint64_t key) {
+	__m128i needle = _mm_set1_epi64x((long long)key);
+	size_t i;
+
+	for (i = 0; i + 2 <= count; i += 2) {
+		__m128i halves = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(keys + i)), needle);
+
+		// A key matches only where both of its halves match.
+		__m128i match = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+		int mask = _mm_movemask_pd(_mm_castsi128_pd(match));
+
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	// Finish off the odd key.
+	return i + ll_key_scan_scalar(keys + i, count - i, key);
+}
+
+/* AVX2 version of ll_key_scan_scalar, comparing eight keys at a time. */
+__attribute__((target("avx2")))
+static size_t ll_key_scan_avx2(const uint64_t *keys, size_t count, uint64_t key) {
+	__m256i needle = _mm256_set1_epi64x((long long)key);
+	size_t i;
+
+	for (i = 0; i + 8 <= count; i += 8) {
+		__m256i low = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(keys + i)), needle);
+		__m256i high = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(keys + i + 4)), needle);
+		int mask = _mm256_movemask_pd(_mm256_castsi256_pd(low)) | (_mm256_movemask_pd(_mm256_castsi256_pd(high)) << 4);
+
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	// Finish off the remaining keys.
+	return i + ll_key_scan_sse2(keys + i, count - i, key);
+}
+#endif
+
+/* Returns the index of the first of count keys equal to key, or count if there is none,
+ * using the widest compare the CPU supports. */
+static size_t ll_key_scan(const uint64_t *keys, size_t count, uint64_t key) {
+	static size_t (*kernel)(const uint64_t *keys, size_t count, uint64_t key) = NULL;
+
+	size_t (*scan)(const uint64_t *, size_t, uint64_t) = __atomic_load_n(&kernel, __ATOMIC_RELAXED);
+
+	// Pick the kernel on first use. Racing threads all pick the same one.
+	if (scan == NULL) {
+#if defined(__x86_64__)
+		__builtin_cpu_init();
+		scan = __builtin_cpu_supports("avx2") ? ll_key_scan_avx2 : ll_key_scan_sse2;
+#else
+		scan = ll_key_scan_scalar;
+#endif
+		__atomic_store_n(&kernel, scan, __ATOMIC_RELAXED);
+	}
+
+	return scan(keys, count, key);
+}
+
+/* Returns the index of the first element with the given key, or the size if there is none.
+ * Must be called with the lock held on a keyed deque list. */
+static size_t ll_deque_find_key(linked_list_t *ll, uint64_t key) {
+	ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+	// Scan the part up to the end of the buffer, then the part that wrapped around.
+	size_t first = deque->capacity - deque->start;
+	if (first > ll->size) {
+		first = ll->size;
+	}
+
+	size_t index = ll_key_scan(deque->keys + deque->start, first, key);
+
+	if (index == first && first < ll->size) {
+		index = first + ll_key_scan(deque->keys, ll->size - first, key);
+	}
+
+	return index;
+}
+
+/* Creates a new empty list backed by a ring buffer of data pointers instead of nodes.
+ * Pushing and popping at either end is O(1) and no memory is allocated per element. */
+linked_list_t *ll_new_deque(void) {
+	// Start from a regular linked list.
+	linked_list_t *ll = ll_new();
+
+	if (ll == NULL) {
+		return NULL;
+	}
+
+	// Allocate the ring buffer.
+	ll_deque_t *deque = calloc(1, sizeof(ll_deque_t));
+
+	if (deque == NULL) {
+		ll_destroy(ll);
+
+		return NULL;
+	}
+
+	deque->capacity = LL_DEQUE_INITIAL_CAPACITY;
+	deque->items = malloc(deque->capacity * sizeof(void *));
+
+	// Point the structure's deque at the ring buffer.
+	ll->deque = (void *)deque;
+
+	// Out of memory, give up on the list.
+	if (deque->items == NULL) {
+		ll_destroy(ll);
+
+		return NULL;
+	}
+
+	// Return linked list management node.
+	return ll;
+}
+
+/* Creates a new empty deque list that stores a 64-bit key next to each element.
+ * Keys are packed contiguously so ll_pop_by_key and ll_find_key_u64 can compare them with SIMD. */
+linked_list_t *ll_new_keyed(void) {
+	// Start from a deque list.
+	linked_list_t *ll = ll_new_deque();
+
+	if (ll == NULL) {
+		return NULL;
+	}
+
+	// Allocate the keys alongside the ring buffer.
+	ll_deque_t *deque = (ll_deque_t *)ll->deque;
+	deque->keys = malloc(deque->capacity * sizeof(uint64_t));
+
+	// Out of memory, give up on the list.
+	if (deque->keys == NULL) {
+		ll_destroy(ll);
+
+		return NULL;
+	}
+
 	// Return linked list management node.
 	return ll;
 }
@@ -39,6 +746,36 @@ void ll_destroy(linked_list_t *ll) {
 		free(ll_pop_head(ll));
 	}
 
+	// Free the epoch state and every node still waiting to be reclaimed.
+	if (ll->epoch != NULL) {
+		ll_epoch_t *epoch = (ll_epoch_t *)ll->epoch;
+
+		size_t i;
+		for (i = 0; i < epoch->limbo_size; i++) {
+			free(epoch->limbo[i].data);
+			ll_free_node(ll, epoch->limbo[i].node);
+		}
+
+		free(epoch->limbo);
+		free(epoch);
+	}
+
+	// Free the ring buffer of a deque list.
+	if (ll->deque != NULL) {
+		free(((ll_deque_t *)ll->deque)->items);
+		free(((ll_deque_t *)ll->deque)->keys);
+		free(ll->deque);
+	}
+
+	// Free the pooled block, which releases every pooled node at once.
+	if (ll->pool != NULL) {
+		free(((ll_pool_t *)ll->pool)->block);
+		free(ll->pool);
+	}
+
+	// Free the budget.
+	free(ll->budget);
+
 	// Free mutex.
 	pthread_mutex_destroy(ll->lock);
 	free(ll->lock);
@@ -52,23 +789,115 @@ size_t ll_size(linked_list_t *ll) {
 	return ll->size;
 }
 
-static node_t *ll_partition(node_t *low, node_t *high, int (*compare_function)(void *first_data, void *second_data)) {
-	node_t *i = low->prev;
-	node_t *j;
+/* Enters a read-side critical section and returns the token to pass to ll_read_unlock.
+ * In RCU mode this claims a reader slot instead of taking the lock. */
+int ll_read_lock(linked_list_t *ll) {
+	ll_epoch_t *epoch = (ll_epoch_t *)ll->epoch;
 
-	for (j = low; j != high; j = j->next) {
-		if (compare_function(j->data, high->data) < 0) {
-			i = (i == NULL) ? low : i->next;
-			void *t = i->data;
-			i->data = j->data;
-			j->data = t;
-		}
+	// Without RCU mode readers share the writers' mutex.
+	if (epoch == NULL) {
+		pthread_mutex_lock((pthread_mutex_t *)ll->lock);
+
+		return -1;
 	}
 
-	i = (i == NULL) ? low : i->next;
-	void *t = i->data;
-	i->data = high->data;
-	high->data = t;
+	// Claim a free slot and announce the epoch this reader started in.
+	for (;;) {
+		int i;
+		for (i = 0; i < LL_EPOCH_SLOTS; i++) {
+			unsigned long expected = 0;
+			unsigned long slot = (__atomic_load_n(&epoch->global, __ATOMIC_SEQ_CST) << 1) | 1;
+
+			if (__atomic_compare_exchange_n(&epoch->slots[i], &expected, slot, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+				return i;
+			}
+		}
+
+		// Every slot is busy, let another reader finish.
+		sched_yield();
+	}
+}
+
+/* Leaves the read-side critical section entered by ll_read_lock. */
+void ll_read_unlock(linked_list_t *ll, int token) {
+	ll_epoch_t *epoch = (ll_epoch_t *)ll->epoch;
+
+	// Without RCU mode the reader holds the mutex.
+	if (epoch == NULL) {
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return;
+	}
+
+	// Release the slot, nodes retired from now on no longer wait for this reader.
+	__atomic_store_n(&epoch->slots[token], 0, __ATOMIC_RELEASE);
+}
+
+/* Returns the data of the first node the provided compare function returns true for, without removing it.
+ * In RCU mode the list is traversed without taking the lock. */
+void *ll_find(linked_list_t *ll, bool (*compare_function)(void *cmd_data)) {
+	// Enter a read-side critical section.
+	int token = ll_read_lock(ll);
+
+	void *data = NULL;
+
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		size_t index = ll_deque_find(ll, compare_function);
+
+		if (index < ll->size) {
+			ll_deque_t *deque = (ll_deque_t *)ll->deque;
+			data = deque->items[ll_deque_position(deque, index)];
+		}
+
+		// Leave the read-side critical section.
+		ll_read_unlock(ll, token);
+
+		return data;
+	}
+
+	// Point at the head of the linked list.
+	node_t *current = LL_FOLLOW(ll->head);
+
+	// While there are nodes in the linked list.
+	while (current != NULL) {
+		// Load the data once, ll_sort may be moving it between nodes.
+		void *current_data = LL_FOLLOW(current->data);
+
+		// If the provided compare_function returns true.
+		if (compare_function(current_data)) {
+			data = current_data;
+			break;
+		}
+
+		// Point to the next node in the linked list.
+		current = LL_FOLLOW(current->next);
+	}
+
+	// Leave the read-side critical section.
+	ll_read_unlock(ll, token);
+
+	// Return the data, or NULL if it wasn't found.
+	return data;
+}
+
+static node_t *ll_partition(node_t *low, node_t *high, int (*compare_function)(void *first_data, void *second_data)) {
+	node_t *i = low->prev;
+	node_t *j;
+
+	for (j = low; j != high; j = j->next) {
+		if (compare_function(j->data, high->data) < 0) {
+			i = (i == NULL) ? low : i->next;
+			void *t = i->data;
+			LL_PUBLISH(i->data, j->data);
+			LL_PUBLISH(j->data, t);
+		}
+	}
+
+	i = (i == NULL) ? low : i->next;
+	void *t = i->data;
+	LL_PUBLISH(i->data, high->data);
+	LL_PUBLISH(high->data, t);
 
 	return i;
 }
@@ -86,6 +915,23 @@ void ll_sort(linked_list_t *ll, int (*compare_function)(void *first_data, void *
 	// Lock the linked list while being sorted.
 	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+		// A wrapped ring is rotated in place so the elements can be sorted as one array.
+		if (deque->start + ll->size > deque->capacity) {
+			ll_deque_rotate_to_front(deque);
+		}
+
+		ll_array_quick_sort(deque->items + deque->start, (deque->keys != NULL) ? deque->keys + deque->start : NULL, ll->size, compare_function);
+
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return;
+	}
+
 	// Sort the linked list.
 	ll_quick_sort(ll->head, ll->tail, compare_function);
 
@@ -93,117 +939,686 @@ void ll_sort(linked_list_t *ll, int (*compare_function)(void *first_data, void *
 	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
 }
 
-/* Push data onto the tail of the provided linked list and adjust the tail. */
-void ll_push_tail(linked_list_t *ll, void *data) {
-	// Lock the linked list to ensure mutual exclusion.
-	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
+/* Links count nodes of a block into a chain in block order. */
+static void ll_link_block(node_t *block, size_t count) {
+	size_t i;
+	for (i = 0; i < count; i++) {
+		block[i].prev = (i == 0) ? NULL : &block[i - 1];
+		block[i].next = (i == count - 1) ? NULL : &block[i + 1];
+	}
+}
+
+/* Moves every node into one contiguous block laid out in list order, so traversals walk memory sequentially.
+ * The block becomes the list's pool: nodes popped from it are reused by later pushes. */
+void ll_compact(linked_list_t *ll) {
+	// Lock the linked list while the nodes are moved.
+	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
+
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		// Shrink the ring to the smallest power of two that holds the elements.
+		size_t capacity = LL_DEQUE_INITIAL_CAPACITY;
+		while (capacity < ll->size) {
+			capacity *= 2;
+		}
+
+		ll_deque_resize(ll, capacity);
+
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return;
+	}
+
+	// Nothing to lay out.
+	if (ll->size == 0) {
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return;
+	}
+
+	// Allocate the new block and, the first time around, the pool that tracks it.
+	node_t *block = malloc(ll->size * sizeof(node_t));
+	ll_pool_t *pool = (ll->pool != NULL) ? (ll_pool_t *)ll->pool : calloc(1, sizeof(ll_pool_t));
+
+	// Out of memory, leave the list as it is.
+	if (block == NULL || pool == NULL) {
+		free(block);
+		if (pool != ll->pool) {
+			free(pool);
+		}
+
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return;
+	}
+
+	ll->pool = (void *)pool;
+
+	// Copy the data into the block in list order.
+	node_t *current = ll->head;
+	size_t i;
+	for (i = 0; i < ll->size; i++) {
+		block[i].data = current->data;
+		current = current->next;
+	}
+
+	// Link each node in the block to its neighbours.
+	ll_link_block(block, ll->size);
+
+	// Keep track of the old nodes.
+	node_t *old_head = ll->head;
+
+	// Point readers at the new block.
+	LL_PUBLISH(ll->head, &block[0]);
+	LL_PUBLISH(ll->tail, &block[ll->size - 1]);
+
+	// In RCU mode, wait until no reader can still be walking the old nodes.
+	if (ll->epoch != NULL) {
+		ll_epoch_synchronize(ll);
+	}
+
+	// Free the old nodes that were allocated individually.
+	current = old_head;
+	while (current != NULL) {
+		node_t *next = current->next;
+
+		if (!ll_pool_owns(pool, current)) {
+			ll_free_node(ll, current);
+		}
+
+		current = next;
+	}
+
+	// The old block goes in one piece, including any nodes waiting on its free list.
+	free(pool->block);
+
+	// The new block is fully in use.
+	pool->block = block;
+	pool->capacity = ll->size;
+	pool->free_list = NULL;
+
+	// Unlock the linked list now that the list is compacted.
+	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+}
+
+/* Copies the data pointers of the list, head first, into an array in one locked pass.
+ * If *out is NULL an array of the list's size is allocated, which the caller must free.
+ * Otherwise *out must hold *n pointers; if that is too small nothing is copied and false is returned.
+ * On return *n holds the number of elements in the list. */
+bool ll_snapshot(linked_list_t *ll, void ***out, size_t *n) {
+	// Lock the linked list so the snapshot is consistent.
+	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
+
+	void **items = *out;
+
+	// Allocate the array when the caller did not provide one.
+	if (items == NULL) {
+		items = malloc((ll->size > 0 ? ll->size : 1) * sizeof(void *));
+	} else if (*n < ll->size) {
+		items = NULL;
+	}
+
+	// Report the size needed either way.
+	*n = ll->size;
+
+	// The array is missing or too small.
+	if (items == NULL) {
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return false;
+	}
+
+	if (ll->deque != NULL) {
+		ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+		// Copy the part up to the end of the buffer, then the part that wrapped around.
+		size_t first = deque->capacity - deque->start;
+		if (first > ll->size) {
+			first = ll->size;
+		}
+
+		memcpy(items, deque->items + deque->start, first * sizeof(void *));
+		memcpy(items + first, deque->items, (ll->size - first) * sizeof(void *));
+	} else {
+		// Walk the list from the head.
+		node_t *current = ll->head;
+		size_t i;
+		for (i = 0; i < ll->size; i++) {
+			LL_PREFETCH(current->next);
+			items[i] = current->data;
+			current = current->next;
+		}
+	}
+
+	*out = items;
+
+	// Unlock the linked list.
+	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+	return true;
+}
+
+/* Creates a new linked list holding the provided data pointers in order.
+ * All nodes are allocated in one block, which becomes the list's pool as with ll_compact. */
+linked_list_t *ll_from_array(void **items, size_t n) {
+	// Start from an empty linked list.
+	linked_list_t *ll = ll_new();
+
+	// Nothing to add.
+	if (ll == NULL || n == 0) {
+		return ll;
+	}
+
+	// Allocate every node at once, along with the pool that tracks them.
+	node_t *block = malloc(n * sizeof(node_t));
+	ll_pool_t *pool = malloc(sizeof(ll_pool_t));
+
+	// Out of memory, give up on the list.
+	if (block == NULL || pool == NULL) {
+		free(block);
+		free(pool);
+		ll_destroy(ll);
+
+		return NULL;
+	}
+
+	// Point each node at its data and link the nodes in order.
+	size_t i;
+	for (i = 0; i < n; i++) {
+		block[i].data = items[i];
+	}
+
+	ll_link_block(block, n);
+
+	// The block is fully in use.
+	pool->block = block;
+	pool->capacity = n;
+	pool->free_list = NULL;
+	ll->pool = (void *)pool;
+
+	// Head and tail are the ends of the block.
+	ll->head = &block[0];
+	ll->tail = &block[n - 1];
+	ll->size = n;
+
+	// Return linked list management node.
+	return ll;
+}
+
+/* Returns the bytes held by the list itself, excluding the data. Must be called with the lock held. */
+static size_t ll_memory_usage_base(linked_list_t *ll) {
+	// The management node, its mutex and budget, and every node allocated on its own.
+	size_t bytes = sizeof(linked_list_t) + sizeof(pthread_mutex_t) + sizeof(ll_budget_t) + ((ll_budget_t *)ll->budget)->node_bytes;
+
+	// The epoch state and the room for retired nodes.
+	if (ll->epoch != NULL) {
+		bytes += sizeof(ll_epoch_t) + ((ll_epoch_t *)ll->epoch)->limbo_capacity * sizeof(ll_retired_t);
+	}
+
+	// The pooled block, whether its nodes are in use or free.
+	if (ll->pool != NULL) {
+		bytes += sizeof(ll_pool_t) + ((ll_pool_t *)ll->pool)->capacity * sizeof(node_t);
+	}
+
+	// The ring buffer and its keys.
+	if (ll->deque != NULL) {
+		ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+		bytes += sizeof(ll_deque_t) + deque->capacity * sizeof(void *);
+		if (deque->keys != NULL) {
+			bytes += deque->capacity * sizeof(uint64_t);
+		}
+	}
+
+	return bytes;
+}
+
+/* Returns the bytes one more push would add to the list's memory usage. Must be called with the lock held. */
+static size_t ll_push_cost(linked_list_t *ll) {
+	// A deque list only grows when its ring is full, and then doubles.
+	if (ll->deque != NULL) {
+		ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+		if (ll->size < deque->capacity) {
+			return 0;
+		}
+
+		return deque->capacity * ((deque->keys != NULL) ? sizeof(void *) + sizeof(uint64_t) : sizeof(void *));
+	}
+
+	// A free pooled node costs nothing.
+	ll_pool_t *pool = (ll_pool_t *)ll->pool;
+	if (pool != NULL && pool->free_list != NULL) {
+		return 0;
+	}
+
+	return sizeof(node_t);
+}
+
+/* Returns true if one more push would break the element count limit. */
+static bool ll_over_size(linked_list_t *ll) {
+	ll_budget_t *budget = (ll_budget_t *)ll->budget;
+
+	return budget->max_size != 0 && ll->size >= budget->max_size;
+}
+
+/* Returns true if one more push would break the byte limit. */
+static bool ll_over_bytes(linked_list_t *ll) {
+	ll_budget_t *budget = (ll_budget_t *)ll->budget;
+
+	return budget->max_bytes != 0 && ll_memory_usage_base(ll) + ll_push_cost(ll) > budget->max_bytes;
+}
+
+/* Replaces the contents of the list with the provided data pointers in order, reusing the existing nodes.
+ * The data previously on the list is not freed. Returns false if memory ran out or the items break the
+ * list's limits, in which case the list holds as many of the items as fit. No elements are dropped to make room. */
+bool ll_replace_from_array(linked_list_t *ll, void **items, size_t n) {
+	// Lock the linked list while it is rebuilt.
+	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
+
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+		ll_budget_t *budget = (ll_budget_t *)ll->budget;
+		size_t slot_bytes = (deque->keys != NULL) ? sizeof(void *) + sizeof(uint64_t) : sizeof(void *);
+
+		// Take no more items than the element limit allows.
+		size_t count = n;
+		if (budget->max_size != 0 && count > budget->max_size) {
+			count = budget->max_size;
+		}
+
+		// Find a capacity that holds the items, stopping at the byte limit.
+		size_t capacity = deque->capacity;
+		while (capacity < count) {
+			if (budget->max_bytes != 0 && ll_memory_usage_base(ll) + (capacity * 2 - deque->capacity) * slot_bytes > budget->max_bytes) {
+				count = capacity;
+				break;
+			}
+
+			capacity *= 2;
+		}
+
+		// Grow the buffer if needed.
+		if (capacity != deque->capacity && !ll_deque_resize(ll, capacity)) {
+			// Unlock the linked list.
+			pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+			return false;
+		}
+
+		// Copy the items in from the start of the buffer.
+		memcpy(deque->items, items, count * sizeof(void *));
+		deque->start = 0;
+		ll->size = count;
+
+		// The items carry no keys. LL_NO_KEY has every bit set.
+		if (deque->keys != NULL) {
+			memset(deque->keys, 0xff, count * sizeof(uint64_t));
+		}
+
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return count == n;
+	}
+
+	// Overwrite the data of the nodes already on the list.
+	node_t *current = ll->head;
+	size_t i = 0;
+	while (current != NULL && i < n) {
+		LL_PREFETCH(current->next);
+		LL_PUBLISH(current->data, items[i++]);
+		current = current->next;
+	}
+
+	if (current != NULL) {
+		// There are fewer items than nodes, so cut the list after the last overwritten node.
+		node_t *new_tail = current->prev;
+
+		if (new_tail == NULL) {
+			LL_PUBLISH(ll->head, NULL);
+		} else {
+			LL_PUBLISH(new_tail->next, NULL);
+		}
+
+		LL_PUBLISH(ll->tail, new_tail);
+		ll->size = n;
+
+		// Retire the nodes that were cut off.
+		while (current != NULL) {
+			node_t *next = current->next;
+			ll_retire_node(ll, current);
+			current = next;
+		}
+	}
+
+	// There are more items than nodes, so append the rest at the tail.
+	for (; i < n; i++) {
+		// The list is at its limits, keep what was added so far.
+		if (ll_over_size(ll) || ll_over_bytes(ll)) {
+			// Unlock the linked list.
+			pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+			return false;
+		}
+
+		node_t *new_node = ll_alloc_node(ll);
+
+		// Out of memory, keep what was added so far.
+		if (new_node == NULL) {
+			// Unlock the linked list.
+			pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+			return false;
+		}
+
+		new_node->data = items[i];
+		new_node->next = NULL;
+		new_node->prev = ll->tail;
+
+		if (ll->tail == NULL) {
+			LL_PUBLISH(ll->head, new_node);
+		} else {
+			LL_PUBLISH(ll->tail->next, new_node);
+		}
+
+		LL_PUBLISH(ll->tail, new_node);
+		ll->size++;
+	}
+
+	// Unlock the linked list.
+	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+	return true;
+}
+
+/* Links a new node holding data onto the tail of the linked list.
+ * Returns false if the node cannot be allocated. Must be called with the lock held. */
+static bool ll_link_tail(linked_list_t *ll, void *data) {
+	// Make a new node, fully set up before any reader can reach it.
+	node_t *new_node = ll_alloc_node(ll);
+
+	// Out of memory, leave the list untouched.
+	if (new_node == NULL) {
+		return false;
+	}
+
+	// Set the node to point to the data;
+	new_node->data = data;
+
+	// New node is the new tail, so next node is null.
+	new_node->next = NULL;
+
+	// Set the node to point back at the previous tail (NULL if the list is empty).
+	new_node->prev = ll->tail;
+
+	// Corner case where there are no elements on the linked list.
+	if (ll->size == 0) {
+		// Head and tail are the same.
+		LL_PUBLISH(ll->head, new_node);
+	} else {
+		// Link the new node after the previous tail.
+		LL_PUBLISH(ll->tail->next, new_node);
+	}
+
+	// Set the tail to be the new node.
+	LL_PUBLISH(ll->tail, new_node);
+
+	// Increase the size.
+	ll->size++;
+
+	return true;
+}
+
+/* Links a new node holding data onto the head of the linked list.
+ * Returns false if the node cannot be allocated. Must be called with the lock held. */
+static bool ll_link_head(linked_list_t *ll, void *data) {
+	// Make a new node, fully set up before any reader can reach it.
+	node_t *new_node = ll_alloc_node(ll);
+
+	// Out of memory, leave the list untouched.
+	if (new_node == NULL) {
+		return false;
+	}
+
+	// Set the node to point to the data.
+	new_node->data = data;
+
+	// Set the node to point to the previous head (NULL if the list is empty).
+	new_node->next = ll->head;
+
+	// New node is the new head, so previous node is null.
+	new_node->prev = NULL;
+
+	// Corner case where there are no elements on the linked list.
+	if (ll->size == 0) {
+		// Head and tail are the same.
+		LL_PUBLISH(ll->tail, new_node);
+	} else {
+		// Point the previous head back at the new node.
+		LL_PUBLISH(ll->head->prev, new_node);
+	}
+
+	// Set the head to be the new node.
+	LL_PUBLISH(ll->head, new_node);
+
+	// Increase the size.
+	ll->size++;
+
+	return true;
+}
+
+/* Removes the head (or tail) of the list and frees its data. In RCU mode the data is only freed with the
+ * node, as readers may still be using it. The list must not be empty. Must be called with the lock held. */
+static void ll_drop_end(linked_list_t *ll, bool tail) {
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		free(ll_deque_remove(ll, (tail) ? ll->size - 1 : 0));
+		return;
+	}
+
+	node_t *node = (tail) ? ll->tail : ll->head;
+
+	// The previous node (or the head) now points to the node's next node.
+	if (node->prev == NULL) {
+		LL_PUBLISH(ll->head, node->next);
+	} else {
+		LL_PUBLISH(node->prev->next, node->next);
+	}
+
+	// The next node (or the tail) now points to the node's previous node.
+	if (node->next == NULL) {
+		LL_PUBLISH(ll->tail, node->prev);
+	} else {
+		LL_PUBLISH(node->next->prev, node->prev);
+	}
+
+	// Retire the node and its data now that they are unreachable.
+	ll_retire(ll, node, node->data);
+
+	// Decrease the size.
+	ll->size--;
+}
+
+/* Makes room for one more element within the list's limits, applying the overflow policy. The drop-oldest
+ * policy frees elements from the tail if evict_tail is set and from the head otherwise. Returns LL_OK if the
+ * element may be added, LL_DROPPED if the drop-newest policy freed the data or LL_ERR_FULL.
+ * Must be called with the lock held. */
+static int ll_admit(linked_list_t *ll, void *data, bool evict_tail) {
+	ll_budget_t *budget = (ll_budget_t *)ll->budget;
+
+	// Make room by freeing the oldest elements.
+	if (budget->policy == LL_OVERFLOW_DROP_OLDEST) {
+		while (ll->size > 0 && ll_over_size(ll)) {
+			ll_drop_end(ll, evict_tail);
+		}
+
+		// Stop once dropping no longer frees memory, as with nodes waiting on RCU readers.
+		while (ll->size > 0 && ll_over_bytes(ll)) {
+			size_t footprint = ll_memory_usage_base(ll) + ll_push_cost(ll);
+
+			ll_drop_end(ll, evict_tail);
+
+			// In RCU mode the element is only retired. With no readers about, two epochs on it can be freed.
+			if (ll->epoch != NULL) {
+				ll_epoch_reclaim(ll);
+				ll_epoch_reclaim(ll);
+			}
+
+			if (ll_memory_usage_base(ll) + ll_push_cost(ll) >= footprint) {
+				break;
+			}
+		}
+	}
+
+	// There is room for the data.
+	if (!ll_over_size(ll) && !ll_over_bytes(ll)) {
+		return LL_OK;
+	}
+
+	// Dropping the newest element means dropping this one.
+	if (budget->policy == LL_OVERFLOW_DROP_NEWEST) {
+		free(data);
+
+		return LL_DROPPED;
+	}
+
+	return LL_ERR_FULL;
+}
 
-	// Corner case where there are no elements on the linked list.
-	if (ll->size == 0) {
-		// Make a new node at the tail pointer.
-		ll->tail = malloc(sizeof(node_t));
+/* Makes room for data pushed at an index as by ll_push_at_index and stores the position it goes in.
+ * Elements dropped from the head shift the position down with the rest of the list. Returns the same
+ * codes as ll_admit. Must be called with the lock held. */
+static int ll_admit_at(linked_list_t *ll, void *data, int index, size_t *position) {
+	// Resolve the index against the list the caller pushed into.
+	size_t size = ll->size;
+	*position = ll_deque_index_at(ll, index);
 
-		// Set the node to point to the data;
-		ll->tail->data = data;
+	int status = ll_admit(ll, data, false);
 
-		// Ensure that the tail points to NULL.
-		ll->tail->next = NULL;
+	// Anything dropped was in front of the position.
+	size_t dropped = size - ll->size;
+	*position = (*position > dropped) ? *position - dropped : 0;
 
-		// Head and tail are the same.
-		ll->head = ll->tail;
+	return status;
+}
 
-		// Ensure that the head points back at NULL.
-		ll->head->prev = NULL;
+/* Pushes data onto the tail (or head) of the list within its limits, applying the overflow policy.
+ * The oldest elements sit at the other end of the list. The key is only stored on keyed lists. */
+static int ll_try_push(linked_list_t *ll, void *data, uint64_t key, bool tail) {
+	// Lock the linked list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
-		// Increase the size.
-		ll->size++;
+	int status = ll_admit(ll, data, !tail);
 
+	// No room for the data.
+	if (status != LL_OK) {
 		// Unlock the linked list.
 		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
 
-		return;
+		return status;
 	}
 
-	// Make a new node at the end.
-	ll->tail->next = malloc(sizeof(node_t));
+	bool pushed;
 
-	// Set the node to point to the data;
-	ll->tail->next->data = data;
+	if (ll->deque != NULL) {
+		// Deque lists keep their elements in a ring buffer instead of nodes.
+		pushed = ll_deque_insert(ll, (tail) ? ll->size : 0, data, key);
+	} else {
+		pushed = (tail) ? ll_link_tail(ll, data) : ll_link_head(ll, data);
+	}
 
-	// Set the node to point back at the previous tail.
-	ll->tail->next->prev = ll->tail;
+	// Unlock the linked list.
+	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
 
-	// New node is the new tail, so next node is null.
-	ll->tail->next->next = NULL;
+	return (pushed) ? LL_OK : LL_ERR_NOMEM;
+}
 
-	// Set the tail to be the new node.
-	ll->tail = ll->tail->next;
+/* Sets the most elements and bytes the list may hold, 0 meaning unlimited, and what a push does once they are reached.
+ * Bytes are counted as by ll_memory_usage. Limits only apply to later pushes. */
+void ll_set_limits(linked_list_t *ll, size_t max_size, size_t max_bytes, ll_overflow_t policy) {
+	// Lock the linked list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
-	// Increase the size.
-	ll->size++;
+	ll_budget_t *budget = (ll_budget_t *)ll->budget;
+	budget->max_size = max_size;
+	budget->max_bytes = max_bytes;
+	budget->policy = policy;
 
 	// Unlock the linked list.
 	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
 }
 
-/* Push data onto the head of the provided linked list and adjust the head. */
-void ll_push_head(linked_list_t *ll, void *data) {
+/* Returns the bytes allocated by the list itself: the management node and its lock, nodes, buffers and
+ * reclamation state. The data the list points at and the allocator's own overhead are not included. */
+size_t ll_memory_usage(linked_list_t *ll) {
 	// Lock the linked list to ensure mutual exclusion.
 	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
-	// Corner case where there are no elements on the linked list.
-	if (ll->size == 0) {
-		// Make a new node at the head pointer.
-		ll->head = malloc(sizeof(node_t));
+	size_t bytes = ll_memory_usage_base(ll);
+
+	// Unlock the linked list.
+	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
 
-		// Set the node to point to the data;
-		ll->head->data = data;
+	return bytes;
+}
 
-		// Ensure that the head points back at NULL.
-		ll->head->prev = NULL;
+/* Push data onto the tail of the provided linked list within its limits.
+ * Returns LL_OK, LL_DROPPED if the data was freed by the drop-newest policy,
+ * LL_ERR_FULL if the list is over its limits or LL_ERR_NOMEM if memory ran out. */
+int ll_try_push_tail(linked_list_t *ll, void *data) {
+	return ll_try_push(ll, data, LL_NO_KEY, true);
+}
 
-		// Head and tail are the same.
-		ll->tail = ll->head;
+/* Push data onto the head of the provided linked list within its limits. Returns the same codes as ll_try_push_tail. */
+int ll_try_push_head(linked_list_t *ll, void *data) {
+	return ll_try_push(ll, data, LL_NO_KEY, false);
+}
 
-		// Ensure the tail points at NULL.
-		ll->tail->next = NULL;
+/* Push data onto the tail of the provided linked list and adjust the tail.
+ * If the list is over its limits or memory runs out, the data is not added and stays with the caller;
+ * use ll_try_push_tail to find out. */
+void ll_push_tail(linked_list_t *ll, void *data) {
+	ll_try_push(ll, data, LL_NO_KEY, true);
+}
 
-		// Increase the size.
-		ll->size++;
+/* Push data onto the head of the provided linked list and adjust the head.
+ * Refused data stays with the caller as with ll_push_tail; use ll_try_push_head to find out. */
+void ll_push_head(linked_list_t *ll, void *data) {
+	ll_try_push(ll, data, LL_NO_KEY, false);
+}
+
+/* Push data into the list after the element found by using the provided compare function. */
+void ll_push_after(linked_list_t *ll, void *data, bool (*compare_function)(void *cmd_data)) {
+	// Lock the linked list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
+
+	// Make room within the list's limits, dropping the oldest elements from the head.
+	int status = ll_admit(ll, data, false);
 
+	// No room for the data, which stays with the caller.
+	if (status != LL_OK) {
 		// Unlock the linked list.
 		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
 
 		return;
 	}
 
-	// Make a new node at the front.
-	ll->head->prev = malloc(sizeof(node_t));
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		ll_deque_insert(ll, ll_deque_index_after(ll, compare_function), data, LL_NO_KEY);
 
-	// Set the node to point to the data.
-	ll->head->prev->data = data;
-
-	// Set the node to point to the previous head.
-	ll->head->prev->next = ll->head;
-
-	// New node is the new head, so previous node is null.
-	ll->head->prev->prev = NULL;
-	
-	// Set the head to be the new node.
-
-	ll->head = ll->head->prev;
-
-	// Increase the size.
-	ll->size++;
-
-	// Unlock the linked list.
-	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
-}
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
 
-/* Push data into the list after the element found by using the provided compare function. */
-void ll_push_after(linked_list_t *ll, void *data, bool (*compare_function)(void *cmd_data)) {
-	// Lock the linked list to ensure mutual exclusion.
-	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
+		return;
+	}
 
 	// Point at the head of the linked list.
 	node_t *current = ll->head;
@@ -221,7 +1636,15 @@ void ll_push_after(linked_list_t *ll, void *data, bool (*compare_function)(void
 	// If the head is the correct node.
 	if (compare_function(current->data)) {
 		// Make a new node.
-		node_t *new_node = malloc(sizeof(node_t));
+		node_t *new_node = ll_alloc_node(ll);
+
+		// Out of memory, leave the list untouched.
+		if (new_node == NULL) {
+			// Unlock the linked list.
+			pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+			return;
+		}
 
 		// Point the new_node at the provided data.
 		new_node->data = data;
@@ -233,10 +1656,10 @@ void ll_push_after(linked_list_t *ll, void *data, bool (*compare_function)(void
 		new_node->next = current->next;
 
 		// Point the next in list pointer back at the new node.
-		current->next->prev = new_node;
+		LL_PUBLISH(current->next->prev, new_node);
 
 		// Point the current next pointer at the new node.
-		current->next = new_node;
+		LL_PUBLISH(current->next, new_node);
 
 		// Increase the size.
 		ll->size++;
@@ -249,10 +1672,21 @@ void ll_push_after(linked_list_t *ll, void *data, bool (*compare_function)(void
 
 	// While there are nodes in the linked list.
 	while (current->next != NULL) {
+		// Start fetching the node after next while this one is compared.
+		LL_PREFETCH(current->next->next);
+
 		// If the provided compare_function returns true.
 		if (compare_function(current->data)) {
 			// Make a new node.
-			node_t *new_node = malloc(sizeof(node_t));
+			node_t *new_node = ll_alloc_node(ll);
+
+			// Out of memory, leave the list untouched.
+			if (new_node == NULL) {
+				// Unlock the linked list.
+				pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+				return;
+			}
 
 			// Point the new_node at the provided data.
 			new_node->data = data;
@@ -264,10 +1698,10 @@ void ll_push_after(linked_list_t *ll, void *data, bool (*compare_function)(void
 			new_node->next = current->next;
 
 			// Point the next in list pointer back at the new node.
-			current->next->prev = new_node;
+			LL_PUBLISH(current->next->prev, new_node);
 
 			// Point the current next pointer at the new node.
-			current->next = new_node;
+			LL_PUBLISH(current->next, new_node);
 
 			// Increase the size.
 			ll->size++;
@@ -304,6 +1738,27 @@ void ll_push_before(linked_list_t *ll, void *data, bool (*compare_function)(void
 	// Lock the linked list to ensure mutual exclusion.
 	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
+	// Make room within the list's limits, dropping the oldest elements from the head.
+	int status = ll_admit(ll, data, false);
+
+	// No room for the data, which stays with the caller.
+	if (status != LL_OK) {
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return;
+	}
+
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		ll_deque_insert(ll, ll_deque_index_before(ll, compare_function), data, LL_NO_KEY);
+
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return;
+	}
+
 	// Point at the head of the linked list.
 	node_t *current = ll->head;
 
@@ -329,10 +1784,21 @@ void ll_push_before(linked_list_t *ll, void *data, bool (*compare_function)(void
 
 	// While there are nodes in the linked list.
 	while (current->next != NULL) {
+		// Start fetching the node after next while this one is compared.
+		LL_PREFETCH(current->next->next);
+
 		// If the provided compare_function returns true.
 		if (compare_function(current->data)) {
 			// Make a new node.
-			node_t *new_node = malloc(sizeof(node_t));
+			node_t *new_node = ll_alloc_node(ll);
+
+			// Out of memory, leave the list untouched.
+			if (new_node == NULL) {
+				// Unlock the linked list.
+				pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+				return;
+			}
 
 			// Point the new_node at the provided data.
 			new_node->data = data;
@@ -344,10 +1810,10 @@ void ll_push_before(linked_list_t *ll, void *data, bool (*compare_function)(void
 			new_node->prev = current->prev;
 
 			// Point the node that came before the current node at the new node.
-			current->prev->next = new_node;
+			LL_PUBLISH(current->prev->next, new_node);
 
 			// Point the current node back at the new node.
-			current->prev = new_node;
+			LL_PUBLISH(current->prev, new_node);
 
 			// Increase the size.
 			ll->size++;
@@ -365,7 +1831,15 @@ void ll_push_before(linked_list_t *ll, void *data, bool (*compare_function)(void
 	// If the tail is the correct node.
 	if (compare_function(current->data)) {
 		// Make a new node.
-		node_t *new_node = malloc(sizeof(node_t));
+		node_t *new_node = ll_alloc_node(ll);
+
+		// Out of memory, leave the list untouched.
+		if (new_node == NULL) {
+			// Unlock the linked list.
+			pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+			return;
+		}
 
 		// Point the new_node at the provided data.
 		new_node->data = data;
@@ -377,10 +1851,10 @@ void ll_push_before(linked_list_t *ll, void *data, bool (*compare_function)(void
 		new_node->prev = current->prev;
 
 		// Point the node that came before the current node at the new node.
-		current->prev->next = new_node;
+		LL_PUBLISH(current->prev->next, new_node);
 
 		// Point the current node back at the new node.
-		current->prev = new_node;
+		LL_PUBLISH(current->prev, new_node);
 
 		// Increase the size.
 		ll->size++;
@@ -403,26 +1877,48 @@ void ll_push_at_index(linked_list_t *ll, void *data, int index) {
 	// Lock the linked list to ensure mutual exclusion.
 	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
+	// Make room within the list's limits, dropping the oldest elements from the head.
+	size_t position;
+	int status = ll_admit_at(ll, data, index, &position);
+
+	// No room for the data, which stays with the caller.
+	if (status != LL_OK) {
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return;
+	}
+
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		ll_deque_insert(ll, position, data, LL_NO_KEY);
+
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return;
+	}
+
 	// Create a pointer to keep track of location in list.
 	node_t *current = NULL;
 
 	// If the linked list is empty or index is head, just push as the head.
-	if (ll->size == 0 || index == 0) {
+	if (ll->size == 0 || position == 0) {
+		ll_link_head(ll, data);
+
 		// Unlock the linked list.
 		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
 
-		ll_push_head(ll, data);
-
 		return;
 	}
 
-	// If the index is the last item in the list, just push as the tail.
-	if (index == ll->size) {
+	// If the index is past the last item in the list, just push as the tail.
+	if (position == ll->size) {
+		ll_link_tail(ll, data);
+
 		// Unlock the linked list.
 		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
 
-		ll_push_tail(ll, data);
-
 		return;
 	}
 
@@ -431,25 +1927,31 @@ void ll_push_at_index(linked_list_t *ll, void *data, int index) {
 		current = ll->head;
 
 		// Iterate over the list until reached the specified index.
-		int i;
-		for (i = 0; i < index; i++) {
+		size_t i;
+		for (i = 0; i < position; i++) {
 			current = current->next;
 		}
 	} else {
-		
 		// Point to the tail node.
 		current = ll->tail;
 
 		// Traverse the list backwards until reached the specified index.
-		int i;
-		for (i = 1; i < 0 - (index); i++) {
-			printf("%d\n", i);
+		size_t i;
+		for (i = ll->size - 1; i > position; i--) {
 			current = current->prev;
 		}
 	}
 
 	// Make a new node to be inserted.
-	node_t *new_node = malloc(sizeof(node_t));
+	node_t *new_node = ll_alloc_node(ll);
+
+	// Out of memory, leave the list untouched.
+	if (new_node == NULL) {
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return;
+	}
 
 	// Point the new node at the provided data.
 	new_node->data = data;
@@ -461,10 +1963,10 @@ void ll_push_at_index(linked_list_t *ll, void *data, int index) {
 	new_node->prev = current->prev;
 
 	// Make the current node's previous node point at the new node.
-	current->prev->next = new_node;
+	LL_PUBLISH(current->prev->next, new_node);
 
 	// Current node is now looking back at new node.
-	current->prev = new_node;
+	LL_PUBLISH(current->prev, new_node);
 
 	// Increase the size.
 	ll->size++;
@@ -478,6 +1980,17 @@ void *ll_pop_head(linked_list_t *ll) {
 	// Lock the linked list to ensure mutual exclusion.
 	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		// If the list is empty, return null.
+		void *data = (ll->size == 0) ? NULL : ll_deque_remove(ll, 0);
+
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return data;
+	}
+
 	void *data = NULL;
 
 	// If the linked list is empty, return null.
@@ -493,12 +2006,15 @@ void *ll_pop_head(linked_list_t *ll) {
 
 	// Corner case where there is only one element on the linked list.
 	if (ll->size == 1) {
-		// Free at the head pointer.
-		free(ll->head);
+		// Keep track of the old head.
+		node_t *old_head = ll->head;
 
 		// The linked list is empty.
-		ll->head = NULL;
-		ll->tail = NULL;
+		LL_PUBLISH(ll->head, NULL);
+		LL_PUBLISH(ll->tail, NULL);
+
+		// Retire the old head now that it is unreachable.
+		ll_retire_node(ll, old_head);
 
 		// Decrease the size.
 		ll->size--;
@@ -510,17 +2026,17 @@ void *ll_pop_head(linked_list_t *ll) {
 		return data;
 	}
 	
-	// Head's next is the new head.
-	ll->head->next->prev = NULL;
+	// Keep track of the old head.
+	node_t *old_head = ll->head;
 
-	// Keep track of the new head.
-	node_t *new_head = ll->head->next;
-
-	// Free the head pointer.
-	free(ll->head);
+	// Head's next is the new head.
+	LL_PUBLISH(old_head->next->prev, NULL);
 
 	// Point at the new head pointer.
-	ll->head = new_head;
+	LL_PUBLISH(ll->head, old_head->next);
+
+	// Retire the old head now that it is unreachable.
+	ll_retire_node(ll, old_head);
 
 	// Decrease the size.
 	ll->size--;
@@ -537,6 +2053,17 @@ void *ll_pop_tail(linked_list_t *ll) {
 	// Lock the linked list to ensure mutual exclusion.
 	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		// If the list is empty, return null.
+		void *data = (ll->size == 0) ? NULL : ll_deque_remove(ll, ll->size - 1);
+
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return data;
+	}
+
 	void *data = NULL;
 
 	// If the linked list is empty, return null.
@@ -552,12 +2079,15 @@ void *ll_pop_tail(linked_list_t *ll) {
 
 	// Corner case where there is only one element on the linked list.
 	if (ll->size == 1) {
-		// Free at the tail pointer.
-		free(ll->tail);
+		// Keep track of the old tail.
+		node_t *old_tail = ll->tail;
 
 		// The linked list is empty.
-		ll->head = NULL;
-		ll->tail = NULL;
+		LL_PUBLISH(ll->head, NULL);
+		LL_PUBLISH(ll->tail, NULL);
+
+		// Retire the old tail now that it is unreachable.
+		ll_retire_node(ll, old_tail);
 
 		// Decrease the size.
 		ll->size--;
@@ -569,17 +2099,17 @@ void *ll_pop_tail(linked_list_t *ll) {
 		return data;
 	}
 
-	// Tail's previous is the new tail.
-	ll->tail->prev->next = NULL;
-
-	// Keep track of the new tail.
-	node_t *new_tail = ll->tail->prev;
+	// Keep track of the old tail.
+	node_t *old_tail = ll->tail;
 
-	// Free the tail pointer.
-	free(ll->tail);
+	// Tail's previous is the new tail.
+	LL_PUBLISH(old_tail->prev->next, NULL);
 
 	// Point at the new tail pointer.
-	ll->tail = new_tail;
+	LL_PUBLISH(ll->tail, old_tail->prev);
+
+	// Retire the old tail now that it is unreachable.
+	ll_retire_node(ll, old_tail);
 
 	// Decrease the size.
 	ll->size--;
@@ -596,6 +2126,18 @@ void *ll_pop_by(linked_list_t *ll, bool (*compare_function)(void *cmd_data)) {
 	// Lock the linked list to ensure mutual exclusion.
 	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		// Node wasn't found in the list.
+		size_t index = ll_deque_find(ll, compare_function);
+		void *data = (index == ll->size) ? NULL : ll_deque_remove(ll, index);
+
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return data;
+	}
+
 	// Point at the head of the linked list.
 	node_t *current = ll->head;
 
@@ -613,12 +2155,12 @@ void *ll_pop_by(linked_list_t *ll, bool (*compare_function)(void *cmd_data)) {
 			// Grab the data before doing anything with the linked list.
 			void *data = current->data;
 
-			// Free at the head pointer.
-			free(ll->head);
-
 			// The linked list is empty.
-			ll->head = NULL;
-			ll->tail = NULL;
+			LL_PUBLISH(ll->head, NULL);
+			LL_PUBLISH(ll->tail, NULL);
+
+			// Retire the node now that it is unreachable.
+			ll_retire_node(ll, current);
 
 			// Decrease the size.
 			ll->size--;
@@ -642,19 +2184,22 @@ void *ll_pop_by(linked_list_t *ll, bool (*compare_function)(void *cmd_data)) {
 
 	// While there are nodes in the linked list.
 	while (current->next != NULL) {
+		// Start fetching the node after next while this one is compared.
+		LL_PREFETCH(current->next->next);
+
 		// If the provided compare_function returns true.
 		if (compare_function(current->data)) {
 			// Grab the data before doing anything with the pointer.
 			void *data = current->data;
 
 			// The previous node now points to the current node's next node.
-			current->prev->next = current->next;
+			LL_PUBLISH(current->prev->next, current->next);
 
 			// The next node now points to the current node's previous node.
-			current->next->prev = current->prev;
+			LL_PUBLISH(current->next->prev, current->prev);
 
-			// Now that the node is out of the linked list, free the node.
-			free(current);
+			// Now that the node is out of the linked list, retire the node.
+			ll_retire_node(ll, current);
 
 			// Decrease the size.
 			ll->size--;
@@ -690,6 +2235,20 @@ void *ll_pop_by_index(linked_list_t *ll, int index) {
 	// Lock the linked list to ensure mutual exclusion.
 	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
+	// Deque lists keep their elements in a ring buffer instead of nodes.
+	if (ll->deque != NULL) {
+		// A negative index counts back from the tail.
+		long long position = (index < 0) ? (long long)ll->size + index : index;
+
+		// If the index is beyond the size of the list, return null.
+		void *data = (position < 0 || position >= (long long)ll->size) ? NULL : ll_deque_remove(ll, (size_t)position);
+
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return data;
+	}
+
 	// If the specified index is the head node.
 	if (index == 0 || index == (ll->size * -1)) {
 		// Unlock the linked list.
@@ -743,13 +2302,16 @@ void *ll_pop_by_index(linked_list_t *ll, int index) {
 	data = current->data;
 
 	// Point the previous node at the next in the list.
-	current->prev->next = current->next;
+	LL_PUBLISH(current->prev->next, current->next);
 
 	// Point the next node at the previous node in the list.
-	current->next->prev = current->prev;
+	LL_PUBLISH(current->next->prev, current->prev);
 
 	// Node is ready to be deallocated.
-	free(current);
+	ll_retire_node(ll, current);
+
+	// Decrease the size.
+	ll->size--;
 
 	// Unlock the linked list.
 	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
@@ -758,13 +2320,202 @@ void *ll_pop_by_index(linked_list_t *ll, int index) {
 	return data;
 }
 
-/* Prints the information about all nodes in the linked list. Useful for debug information. */
-static void ll_print_list_base(linked_list_t *ll, bool reversed) {
+/* Returns true if the list was made with ll_new_keyed. The keys are allocated with the list, so no lock is needed. */
+static bool ll_is_keyed(linked_list_t *ll) {
+	return ll->deque != NULL && ((ll_deque_t *)ll->deque)->keys != NULL;
+}
+
+/* Push data with a 64-bit key onto the tail of the provided keyed list within its limits.
+ * Returns the same codes as ll_try_push_tail, LL_ERR_UNSUPPORTED if the list was not made with ll_new_keyed
+ * or LL_ERR_INVALID if the key is LL_NO_KEY. */
+int ll_push_tail_key(linked_list_t *ll, void *data, uint64_t key) {
+	// Only keyed lists have room for the key.
+	if (!ll_is_keyed(ll)) {
+		return LL_ERR_UNSUPPORTED;
+	}
+
+	// The key marking elements without one cannot be pushed.
+	if (key == LL_NO_KEY) {
+		return LL_ERR_INVALID;
+	}
+
+	return ll_try_push(ll, data, key, true);
+}
+
+/* Push data with a 64-bit key onto the head of the provided keyed list. Returns the same codes as ll_push_tail_key. */
+int ll_push_head_key(linked_list_t *ll, void *data, uint64_t key) {
+	// Only keyed lists have room for the key.
+	if (!ll_is_keyed(ll)) {
+		return LL_ERR_UNSUPPORTED;
+	}
+
+	// The key marking elements without one cannot be pushed.
+	if (key == LL_NO_KEY) {
+		return LL_ERR_INVALID;
+	}
+
+	return ll_try_push(ll, data, key, false);
+}
+
+/* Where ll_push_key puts new data, matching the regular push functions. */
+typedef enum {
+	LL_KEY_AFTER,
+	LL_KEY_BEFORE,
+	LL_KEY_AT_INDEX
+} ll_key_position_t;
+
+/* Pushes data with a key into a keyed list at the position chosen as by ll_push_after, ll_push_before
+ * or ll_push_at_index. Returns the same codes as ll_push_tail_key. */
+static int ll_push_key(linked_list_t *ll, void *data, uint64_t key, ll_key_position_t where, bool (*compare_function)(void *cmd_data), int index) {
+	// Only keyed lists have room for the key.
+	if (!ll_is_keyed(ll)) {
+		return LL_ERR_UNSUPPORTED;
+	}
+
+	// The key marking elements without one cannot be pushed.
+	if (key == LL_NO_KEY) {
+		return LL_ERR_INVALID;
+	}
+
+	// Lock the linked list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
+
+	// Make room within the list's limits, dropping the oldest elements from the head.
+	size_t position;
+	int status = ll_admit_at(ll, data, index, &position);
+
+	// No room for the data.
+	if (status != LL_OK) {
+		// Unlock the linked list.
+		pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+		return status;
+	}
+
+	if (where == LL_KEY_AFTER) {
+		position = ll_deque_index_after(ll, compare_function);
+	} else if (where == LL_KEY_BEFORE) {
+		position = ll_deque_index_before(ll, compare_function);
+	}
+
+	bool pushed = ll_deque_insert(ll, position, data, key);
+
+	// Unlock the linked list.
+	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+	return (pushed) ? LL_OK : LL_ERR_NOMEM;
+}
+
+/* Push data with a key into a keyed list after the element found by using the provided compare function.
+ * Returns the same codes as ll_push_tail_key. */
+int ll_push_after_key(linked_list_t *ll, void *data, uint64_t key, bool (*compare_function)(void *cmd_data)) {
+	return ll_push_key(ll, data, key, LL_KEY_AFTER, compare_function, 0);
+}
+
+/* Push data with a key into a keyed list before the element found by using the provided compare function.
+ * Returns the same codes as ll_push_tail_key. */
+int ll_push_before_key(linked_list_t *ll, void *data, uint64_t key, bool (*compare_function)(void *cmd_data)) {
+	return ll_push_key(ll, data, key, LL_KEY_BEFORE, compare_function, 0);
+}
+
+/* Push data with a key into a keyed list at the specified index, as ll_push_at_index does.
+ * Returns the same codes as ll_push_tail_key. */
+int ll_push_at_index_key(linked_list_t *ll, void *data, uint64_t key, int index) {
+	return ll_push_key(ll, data, key, LL_KEY_AT_INDEX, NULL, index);
+}
+
+/* Remove the first element with the given key and store its data in data.
+ * Returns LL_OK, LL_ERR_NOT_FOUND if no element has the key or LL_ERR_UNSUPPORTED if the list was not made with ll_new_keyed. */
+int ll_pop_by_key(linked_list_t *ll, uint64_t key, void **data) {
+	// Only keyed lists can be searched by key.
+	if (!ll_is_keyed(ll)) {
+		return LL_ERR_UNSUPPORTED;
+	}
+
+	// Elements pushed without a key cannot be found by key.
+	if (key == LL_NO_KEY) {
+		return LL_ERR_NOT_FOUND;
+	}
+
+	// Lock the linked list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
+
+	int status = LL_ERR_NOT_FOUND;
+	size_t index = ll_deque_find_key(ll, key);
+
+	// Remove the element if it was found.
+	if (index < ll->size) {
+		*data = ll_deque_remove(ll, index);
+		status = LL_OK;
+	}
+
+	// Unlock the linked list.
+	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+	return status;
+}
+
+/* Store the data of the first element with the given key in data without removing it. Returns the same codes as ll_pop_by_key. */
+int ll_find_key_u64(linked_list_t *ll, uint64_t key, void **data) {
+	// Only keyed lists can be searched by key.
+	if (!ll_is_keyed(ll)) {
+		return LL_ERR_UNSUPPORTED;
+	}
+
+	// Elements pushed without a key cannot be found by key.
+	if (key == LL_NO_KEY) {
+		return LL_ERR_NOT_FOUND;
+	}
+
 	// Lock the linked list to ensure mutual exclusion.
 	pthread_mutex_lock((pthread_mutex_t *)ll->lock);
 
+	ll_deque_t *deque = (ll_deque_t *)ll->deque;
+	int status = LL_ERR_NOT_FOUND;
+	size_t index = ll_deque_find_key(ll, key);
+
+	if (index < ll->size) {
+		*data = deque->items[ll_deque_position(deque, index)];
+		status = LL_OK;
+	}
+
+	// Unlock the linked list.
+	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+
+	return status;
+}
+
+/* Prints the information about all nodes in the linked list. Useful for debug information. */
+static void ll_print_list_base(linked_list_t *ll, bool reversed) {
+	// Enter a read-side critical section.
+	int token = ll_read_lock(ll);
+
+	// Deque lists print their buffer slots instead of nodes.
+	if (ll->deque != NULL) {
+		ll_deque_t *deque = (ll_deque_t *)ll->deque;
+
+		size_t i;
+		for (i = 0; i < ll->size; i++) {
+			// Walk from the tail instead if reversed.
+			size_t index = (reversed) ? ll->size - 1 - i : i;
+
+			printf(	"Element %zu:\n"			// Print the index of the element we are at.
+					"\tSlot: %zu\n"				// Print the buffer slot holding the element.
+					"\tData: %p\n",				// Print the address of the pointer to the data.
+					index,
+					ll_deque_position(deque, index),
+					deque->items[ll_deque_position(deque, index)]
+				);
+		}
+
+		// Leave the read-side critical section.
+		ll_read_unlock(ll, token);
+
+		return;
+	}
+
 	// Point at the head (or tail if reversed) of the linked list.
-	node_t *current = (reversed) ? ll->tail : ll->head;
+	node_t *current = (reversed) ? LL_FOLLOW(ll->tail) : LL_FOLLOW(ll->head);
 
 	// Integer to track of which node we are on.
 	int index = (reversed) ? ll->size - 1 : 0;
@@ -779,18 +2530,18 @@ static void ll_print_list_base(linked_list_t *ll, bool reversed) {
 				"\tData: %p\n"					// Print the address of the pointer to the data.
 				"\tNext: %p\n",					// Print the address of the pointer to the next node.
 				(reversed) ? index-- : index++,	// Increment (or decrement if reversed) the index after using.
-				(void *)current->prev,
+				(void *)LL_FOLLOW(current->prev),
 				(void *)current,
-				(void *)current->data,
-				(void *)current->next
+				(void *)LL_FOLLOW(current->data),
+				(void *)LL_FOLLOW(current->next)
 			);
 
 		// Point to the next (or previous if reversed) node in the list.
-		current = (reversed) ? current->prev : current->next;
+		current = (reversed) ? LL_FOLLOW(current->prev) : LL_FOLLOW(current->next);
 	}
 
-	// Unlock the linked list.
-	pthread_mutex_unlock((pthread_mutex_t *)ll->lock);
+	// Leave the read-side critical section.
+	ll_read_unlock(ll, token);
 }
 
 /* Variation function to allow for a singular or secondary parameter to reverse the print of the list. */
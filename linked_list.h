@@ -12,17 +12,53 @@ typedef struct linked_list {
 	node_t *tail;
 	size_t size;
 	void *lock;
+	void *epoch;
+	void *pool;
+	void *deque;
+	void *budget;
 } linked_list_t;
 
+/* Results of the ll_try_push and key functions. */
+enum {
+	LL_OK = 0,
+	LL_DROPPED = 1,
+	LL_ERR_FULL = -1,
+	LL_ERR_NOMEM = -2,
+	LL_ERR_UNSUPPORTED = -3,
+	LL_ERR_NOT_FOUND = -4,
+	LL_ERR_INVALID = -5
+};
+
+/* Key a keyed list stores for elements pushed without one. It cannot be pushed or found by key. */
+#define LL_NO_KEY UINT64_MAX
+
+/* What a push does when the list is at its limits. */
+typedef enum {
+	LL_OVERFLOW_REJECT,
+	LL_OVERFLOW_DROP_OLDEST,
+	LL_OVERFLOW_DROP_NEWEST
+} ll_overflow_t;
+
 typedef struct {
 	linked_list_t *ll;
 	bool reversed;
 } ll_print_list_args;
 
 linked_list_t *ll_new(void);
+linked_list_t *ll_new_rcu(void);
+linked_list_t *ll_new_deque(void);
+linked_list_t *ll_new_keyed(void);
 void ll_destroy(linked_list_t *ll); 
 size_t ll_size(linked_list_t *ll);
 void ll_sort(linked_list_t *ll, int (*compare_function)(void *first_data, void *second_data));
+void ll_compact(linked_list_t *ll);
+bool ll_snapshot(linked_list_t *ll, void ***out, size_t *n);
+linked_list_t *ll_from_array(void **items, size_t n);
+bool ll_replace_from_array(linked_list_t *ll, void **items, size_t n);
+void ll_set_limits(linked_list_t *ll, size_t max_size, size_t max_bytes, ll_overflow_t policy);
+size_t ll_memory_usage(linked_list_t *ll);
+int ll_try_push_tail(linked_list_t *ll, void *data);
+int ll_try_push_head(linked_list_t *ll, void *data);
 void ll_push_tail(linked_list_t *ll, void *data);
 void ll_push_head(linked_list_t *ll, void *data);
 void ll_push_after(linked_list_t *ll, void *data, bool (*compare_function)(void *cmd_data));
@@ -32,6 +68,16 @@ void *ll_pop_head(linked_list_t *ll);
 void *ll_pop_tail(linked_list_t *ll);
 void *ll_pop_by(linked_list_t *ll, bool (*compare_function)(void *cmd_data));
 void *ll_pop_by_index(linked_list_t *ll, int index);
+int ll_read_lock(linked_list_t *ll);
+void ll_read_unlock(linked_list_t *ll, int token);
+void *ll_find(linked_list_t *ll, bool (*compare_function)(void *cmd_data));
+int ll_push_tail_key(linked_list_t *ll, void *data, uint64_t key);
+int ll_push_head_key(linked_list_t *ll, void *data, uint64_t key);
+int ll_push_after_key(linked_list_t *ll, void *data, uint64_t key, bool (*compare_function)(void *cmd_data));
+int ll_push_before_key(linked_list_t *ll, void *data, uint64_t key, bool (*compare_function)(void *cmd_data));
+int ll_push_at_index_key(linked_list_t *ll, void *data, uint64_t key, int index);
+int ll_pop_by_key(linked_list_t *ll, uint64_t key, void **data);
+int ll_find_key_u64(linked_list_t *ll, uint64_t key, void **data);
 
 #define ll_print_list(...) var_ll_print_list((ll_print_list_args){__VA_ARGS__});
 void var_ll_print_list(ll_print_list_args args);
@@ -0,0 +1,719 @@
+/* ftruncate, mmap and msync are POSIX, so ask for them explicitly under strict C modes. */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mapped_list.h"
+
+/* Identifies a mapped list file and the version of its layout. */
+static const char ml_magic[8] = { 'L', 'L', 'M', 'A', 'P', 0, 0, 1 };
+
+/* Identifies an exported list stream and the version of its layout. */
+static const char ll_stream_magic[8] = { 'L', 'L', 'S', 'T', 'R', 0, 0, 1 };
+
+/* Size of a new mapped list file. The file doubles whenever it runs out of room. */
+#define ML_INITIAL_LENGTH 4096
+
+/* Largest element a mapped list holds. Keeping it far below 2^64 means node sizes and file lengths cannot overflow. */
+#define ML_MAX_ELEMENT_SIZE ((uint64_t)1 << 32)
+
+/* Offset used in place of a NULL pointer. Offset 0 is always the header. */
+#define ML_NIL 0
+
+/* Header at the start of a mapped list file. All offsets are bytes from the start of the file. */
+typedef struct {
+	char magic[8];
+	uint64_t element_size;
+	uint64_t node_size;
+	uint64_t used;
+	uint64_t free_head;
+	uint64_t head;
+	uint64_t tail;
+	uint64_t size;
+} ml_header_t;
+
+/* A node in the file, followed directly by element_size bytes of element. */
+typedef struct {
+	uint64_t next;
+	uint64_t prev;
+} ml_node_t;
+
+/* Header of an exported list stream, followed by count elements of element_size bytes each. */
+typedef struct {
+	char magic[8];
+	uint64_t element_size;
+	uint64_t count;
+} ll_stream_header_t;
+
+/* Returns the bytes a node takes for elements of element_size bytes. Nodes stay 8-byte aligned. */
+static uint64_t ml_node_size(uint64_t element_size) {
+	return sizeof(ml_node_t) + ((element_size + 7) & ~(uint64_t)7);
+}
+
+/* Returns the header of the mapped list. */
+static ml_header_t *ml_header(mapped_list_t *ml) {
+	return (ml_header_t *)ml->base;
+}
+
+/* Returns the node at the given offset. */
+static ml_node_t *ml_node(mapped_list_t *ml, uint64_t offset) {
+	return (ml_node_t *)((char *)ml->base + offset);
+}
+
+/* Returns the element stored in the node at the given offset. */
+static void *ml_element(mapped_list_t *ml, uint64_t offset) {
+	return (char *)ml->base + offset + sizeof(ml_node_t);
+}
+
+/* Maps the first length bytes of the file. Returns false if the mapping fails. */
+static bool ml_map(mapped_list_t *ml, size_t length) {
+	void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, ml->fd, 0);
+
+	if (base == MAP_FAILED) {
+		return false;
+	}
+
+	ml->base = base;
+	ml->length = length;
+
+	return true;
+}
+
+/* Doubles the file until it can hold another node and maps it again.
+ * Offsets stay valid across the move. Must be called with the lock held. */
+static bool ml_grow(mapped_list_t *ml) {
+	size_t length = ml->length;
+	while (length < ml_header(ml)->used + ml_header(ml)->node_size) {
+		length *= 2;
+	}
+
+	// Extend the file before mapping the new part.
+	if (ftruncate(ml->fd, (off_t)length) != 0) {
+		return false;
+	}
+
+	// Keep the old mapping until the new one is in place.
+	void *old_base = ml->base;
+	size_t old_length = ml->length;
+
+	if (!ml_map(ml, length)) {
+		return false;
+	}
+
+	munmap(old_base, old_length);
+
+	return true;
+}
+
+/* Hands out a node, reusing a released one when possible. Returns ML_NIL if the file cannot grow.
+ * Must be called with the lock held. */
+static uint64_t ml_alloc_node(mapped_list_t *ml) {
+	ml_header_t *header = ml_header(ml);
+
+	// Reuse the most recently released node.
+	if (header->free_head != ML_NIL) {
+		uint64_t offset = header->free_head;
+		header->free_head = ml_node(ml, offset)->next;
+
+		return offset;
+	}
+
+	// Grow the file if the next node does not fit.
+	if (header->used + header->node_size > ml->length) {
+		if (!ml_grow(ml)) {
+			return ML_NIL;
+		}
+
+		// The header moved along with the mapping.
+		header = ml_header(ml);
+	}
+
+	// Take the next never-used node.
+	uint64_t offset = header->used;
+	header->used += header->node_size;
+
+	return offset;
+}
+
+/* Returns true if offset is ML_NIL or points at the start of a node handed out from the file. */
+static bool ml_valid_offset(ml_header_t *header, uint64_t offset) {
+	if (offset == ML_NIL) {
+		return true;
+	}
+
+	return offset >= sizeof(ml_header_t)
+			&& offset < header->used
+			&& (offset - sizeof(ml_header_t)) % header->node_size == 0;
+}
+
+/* Checks that a file mapped in from disk is a consistent mapped list: the header fits the file, every link
+ * lands on a node, the list runs from head to tail with matching back links and size, and the free chain
+ * ends without reaching a node twice. A file torn by a crash between checkpoints fails these checks. */
+static bool ml_check(mapped_list_t *ml, size_t element_size) {
+	ml_header_t *header = ml_header(ml);
+
+	// The header itself. The element size is bounded before the node size is derived from it,
+	// and the node size must match exactly, so nothing below can overflow or divide by zero.
+	if (memcmp(header->magic, ml_magic, sizeof(ml_magic)) != 0
+			|| header->element_size == 0
+			|| header->element_size > ML_MAX_ELEMENT_SIZE
+			|| header->element_size > ml->length
+			|| (element_size != 0 && header->element_size != element_size)
+			|| header->node_size != ml_node_size(header->element_size)
+			|| header->used < sizeof(ml_header_t)
+			|| header->used > ml->length
+			|| (header->used - sizeof(ml_header_t)) % header->node_size != 0) {
+		return false;
+	}
+
+	uint64_t nodes = (header->used - sizeof(ml_header_t)) / header->node_size;
+
+	if (header->size > nodes
+			|| !ml_valid_offset(header, header->head)
+			|| !ml_valid_offset(header, header->tail)
+			|| !ml_valid_offset(header, header->free_head)
+			|| (header->head == ML_NIL) != (header->tail == ML_NIL)) {
+		return false;
+	}
+
+	// One bit per node, so no node is reached twice through either chain.
+	unsigned char *seen = calloc(nodes / 8 + 1, 1);
+
+	if (seen == NULL) {
+		return false;
+	}
+
+	bool valid = true;
+
+	// Walk the list from the head, checking each back link on the way.
+	uint64_t previous = ML_NIL;
+	uint64_t count = 0;
+	uint64_t offset = header->head;
+	while (valid && offset != ML_NIL) {
+		uint64_t slot = (offset - sizeof(ml_header_t)) / header->node_size;
+		ml_node_t *node = ml_node(ml, offset);
+
+		valid = !(seen[slot / 8] & (1 << (slot % 8)))
+				&& node->prev == previous
+				&& ml_valid_offset(header, node->next);
+		seen[slot / 8] |= (unsigned char)(1 << (slot % 8));
+
+		previous = offset;
+		offset = node->next;
+		count++;
+	}
+
+	valid = valid && previous == header->tail && count == header->size;
+
+	// Walk the free chain the same way.
+	offset = header->free_head;
+	while (valid && offset != ML_NIL) {
+		uint64_t slot = (offset - sizeof(ml_header_t)) / header->node_size;
+		ml_node_t *node = ml_node(ml, offset);
+
+		valid = !(seen[slot / 8] & (1 << (slot % 8))) && ml_valid_offset(header, node->next);
+		seen[slot / 8] |= (unsigned char)(1 << (slot % 8));
+
+		offset = node->next;
+	}
+
+	free(seen);
+
+	return valid;
+}
+
+/* Opens the mapped list stored at path, creating it for elements of element_size bytes if it does not exist.
+ * When opening an existing file, element_size may be 0 to accept whatever size the file was created with.
+ * Returns NULL if the file cannot be opened, is not a mapped list, holds elements of another size or has links
+ * that do not add up, as after a crash between checkpoints. */
+mapped_list_t *ll_open_mapped(const char *path, size_t element_size) {
+	// Allocate memory for mapped list management node.
+	mapped_list_t *ml = malloc(sizeof(mapped_list_t));
+
+	if (ml == NULL) {
+		return NULL;
+	}
+
+	// Open the file, creating it if needed.
+	ml->fd = open(path, O_RDWR | O_CREAT, 0644);
+
+	struct stat st;
+	if (ml->fd < 0 || fstat(ml->fd, &st) != 0) {
+		if (ml->fd >= 0) {
+			close(ml->fd);
+		}
+		free(ml);
+
+		return NULL;
+	}
+
+	if (st.st_size == 0) {
+		// A new file needs to know how large its elements are.
+		if (element_size == 0 || element_size > ML_MAX_ELEMENT_SIZE || ftruncate(ml->fd, ML_INITIAL_LENGTH) != 0 || !ml_map(ml, ML_INITIAL_LENGTH)) {
+			close(ml->fd);
+			free(ml);
+
+			return NULL;
+		}
+
+		// Write a header for an empty list.
+		ml_header_t *header = ml_header(ml);
+		memcpy(header->magic, ml_magic, sizeof(ml_magic));
+		header->element_size = element_size;
+		header->node_size = ml_node_size(element_size);
+		header->used = sizeof(ml_header_t);
+		header->free_head = ML_NIL;
+		header->head = ML_NIL;
+		header->tail = ML_NIL;
+		header->size = 0;
+	} else {
+		// Map the existing file as it is.
+		if ((size_t)st.st_size < sizeof(ml_header_t) || !ml_map(ml, (size_t)st.st_size)) {
+			close(ml->fd);
+			free(ml);
+
+			return NULL;
+		}
+
+		// Make sure the file is an intact mapped list of the expected element size.
+		if (!ml_check(ml, element_size)) {
+			munmap(ml->base, ml->length);
+			close(ml->fd);
+			free(ml);
+
+			return NULL;
+		}
+	}
+
+	// Allocate memory for mutex.
+	pthread_mutex_t *ml_mutex = malloc(sizeof(pthread_mutex_t));
+
+	// Initialize mutex.
+	pthread_mutex_init(ml_mutex, NULL);
+
+	// Point the structure's lock to the new mutex.
+	ml->lock = (void *)ml_mutex;
+
+	// Return mapped list management node.
+	return ml;
+}
+
+/* Writes every change made so far back to the file and waits for it to reach the disk.
+ * Changes made after the last checkpoint may be lost, or only partly written, if the system crashes. */
+bool ll_mapped_checkpoint(mapped_list_t *ml) {
+	// Lock the mapped list so the file is written in a consistent state.
+	pthread_mutex_lock((pthread_mutex_t *)ml->lock);
+
+	bool synced = msync(ml->base, ml->length, MS_SYNC) == 0;
+
+	// Unlock the mapped list.
+	pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+	return synced;
+}
+
+/* Checkpoints the mapped list and closes it. The elements stay in the file. */
+void ll_mapped_close(mapped_list_t *ml) {
+	// Make sure everything reaches the file.
+	ll_mapped_checkpoint(ml);
+
+	// Unmap and close the file.
+	munmap(ml->base, ml->length);
+	close(ml->fd);
+
+	// Free mutex.
+	pthread_mutex_destroy(ml->lock);
+	free(ml->lock);
+
+	// Free the mapped list.
+	free(ml);
+}
+
+/* Returns the number of elements in the mapped list. */
+size_t ll_mapped_size(mapped_list_t *ml) {
+	return ml_header(ml)->size;
+}
+
+/* Returns the size in bytes of each element in the mapped list. */
+size_t ll_mapped_element_size(mapped_list_t *ml) {
+	return ml_header(ml)->element_size;
+}
+
+/* Copies the element onto the tail of the mapped list. Returns false if the file cannot grow. */
+bool ll_mapped_push_tail(mapped_list_t *ml, const void *element) {
+	// Lock the mapped list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ml->lock);
+
+	// Make a new node.
+	uint64_t offset = ml_alloc_node(ml);
+
+	if (offset == ML_NIL) {
+		// Unlock the mapped list.
+		pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+		return false;
+	}
+
+	ml_header_t *header = ml_header(ml);
+
+	// Copy the element into the node.
+	memcpy(ml_element(ml, offset), element, header->element_size);
+
+	// New node is the new tail, so next node is nil.
+	ml_node(ml, offset)->next = ML_NIL;
+	ml_node(ml, offset)->prev = header->tail;
+
+	// Link the new node after the previous tail, or as the head if the list is empty.
+	if (header->tail == ML_NIL) {
+		header->head = offset;
+	} else {
+		ml_node(ml, header->tail)->next = offset;
+	}
+
+	// Set the tail to be the new node.
+	header->tail = offset;
+
+	// Increase the size.
+	header->size++;
+
+	// Unlock the mapped list.
+	pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+	return true;
+}
+
+/* Copies the element onto the head of the mapped list. Returns false if the file cannot grow. */
+bool ll_mapped_push_head(mapped_list_t *ml, const void *element) {
+	// Lock the mapped list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ml->lock);
+
+	// Make a new node.
+	uint64_t offset = ml_alloc_node(ml);
+
+	if (offset == ML_NIL) {
+		// Unlock the mapped list.
+		pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+		return false;
+	}
+
+	ml_header_t *header = ml_header(ml);
+
+	// Copy the element into the node.
+	memcpy(ml_element(ml, offset), element, header->element_size);
+
+	// New node is the new head, so previous node is nil.
+	ml_node(ml, offset)->next = header->head;
+	ml_node(ml, offset)->prev = ML_NIL;
+
+	// Link the new node before the previous head, or as the tail if the list is empty.
+	if (header->head == ML_NIL) {
+		header->tail = offset;
+	} else {
+		ml_node(ml, header->head)->prev = offset;
+	}
+
+	// Set the head to be the new node.
+	header->head = offset;
+
+	// Increase the size.
+	header->size++;
+
+	// Unlock the mapped list.
+	pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+	return true;
+}
+
+/* Unlinks the node at offset, copies its element out if element is not NULL and releases the node.
+ * Must be called with the lock held. */
+static void ml_unlink(mapped_list_t *ml, uint64_t offset, void *element) {
+	ml_header_t *header = ml_header(ml);
+	ml_node_t *node = ml_node(ml, offset);
+
+	// Copy the element out before the node is reused.
+	if (element != NULL) {
+		memcpy(element, ml_element(ml, offset), header->element_size);
+	}
+
+	// The previous node (or the head) now points to the node's next node.
+	if (node->prev == ML_NIL) {
+		header->head = node->next;
+	} else {
+		ml_node(ml, node->prev)->next = node->next;
+	}
+
+	// The next node (or the tail) now points to the node's previous node.
+	if (node->next == ML_NIL) {
+		header->tail = node->prev;
+	} else {
+		ml_node(ml, node->next)->prev = node->prev;
+	}
+
+	// Put the node on the free chain.
+	node->next = header->free_head;
+	header->free_head = offset;
+
+	// Decrease the size.
+	header->size--;
+}
+
+/* Removes the head of the mapped list, copying it into element unless element is NULL.
+ * Returns false if the list is empty. */
+bool ll_mapped_pop_head(mapped_list_t *ml, void *element) {
+	// Lock the mapped list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ml->lock);
+
+	// If the mapped list is empty, there is nothing to pop.
+	bool popped = ml_header(ml)->size > 0;
+
+	if (popped) {
+		ml_unlink(ml, ml_header(ml)->head, element);
+	}
+
+	// Unlock the mapped list.
+	pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+	return popped;
+}
+
+/* Removes the tail of the mapped list, copying it into element unless element is NULL.
+ * Returns false if the list is empty. */
+bool ll_mapped_pop_tail(mapped_list_t *ml, void *element) {
+	// Lock the mapped list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ml->lock);
+
+	// If the mapped list is empty, there is nothing to pop.
+	bool popped = ml_header(ml)->size > 0;
+
+	if (popped) {
+		ml_unlink(ml, ml_header(ml)->tail, element);
+	}
+
+	// Unlock the mapped list.
+	pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+	return popped;
+}
+
+/* Copies the head of the mapped list into element without removing it. Returns false if the list is empty. */
+bool ll_mapped_peek_head(mapped_list_t *ml, void *element) {
+	// Lock the mapped list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ml->lock);
+
+	ml_header_t *header = ml_header(ml);
+	bool found = header->size > 0;
+
+	if (found) {
+		memcpy(element, ml_element(ml, header->head), header->element_size);
+	}
+
+	// Unlock the mapped list.
+	pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+	return found;
+}
+
+/* Copies the tail of the mapped list into element without removing it. Returns false if the list is empty. */
+bool ll_mapped_peek_tail(mapped_list_t *ml, void *element) {
+	// Lock the mapped list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ml->lock);
+
+	ml_header_t *header = ml_header(ml);
+	bool found = header->size > 0;
+
+	if (found) {
+		memcpy(element, ml_element(ml, header->tail), header->element_size);
+	}
+
+	// Unlock the mapped list.
+	pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+	return found;
+}
+
+/* Returns the offset of the first node whose element the compare function returns true for, or ML_NIL.
+ * The compare function sees the element in place in the mapping. Must be called with the lock held. */
+static uint64_t ml_find(mapped_list_t *ml, bool (*compare_function)(void *cmd_data)) {
+	uint64_t offset = ml_header(ml)->head;
+
+	while (offset != ML_NIL && !compare_function(ml_element(ml, offset))) {
+		offset = ml_node(ml, offset)->next;
+	}
+
+	return offset;
+}
+
+/* Copies the first element the compare function returns true for into element without removing it.
+ * Returns false if no element matches. */
+bool ll_mapped_find(mapped_list_t *ml, void *element, bool (*compare_function)(void *cmd_data)) {
+	// Lock the mapped list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ml->lock);
+
+	uint64_t offset = ml_find(ml, compare_function);
+
+	if (offset != ML_NIL) {
+		memcpy(element, ml_element(ml, offset), ml_header(ml)->element_size);
+	}
+
+	// Unlock the mapped list.
+	pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+	return offset != ML_NIL;
+}
+
+/* Removes the first element the compare function returns true for, copying it into element unless element is NULL.
+ * Returns false if no element matches. */
+bool ll_mapped_pop_by(mapped_list_t *ml, void *element, bool (*compare_function)(void *cmd_data)) {
+	// Lock the mapped list to ensure mutual exclusion.
+	pthread_mutex_lock((pthread_mutex_t *)ml->lock);
+
+	uint64_t offset = ml_find(ml, compare_function);
+
+	if (offset != ML_NIL) {
+		ml_unlink(ml, offset, element);
+	}
+
+	// Unlock the mapped list.
+	pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+	return offset != ML_NIL;
+}
+
+/* Copies the mapped list into a new linked list, head first, leaving the mapped list as it is.
+ * Each element is copied into its own allocation, owned by the list, and all nodes share one block
+ * as with ll_from_array. Returns NULL if memory runs out. */
+linked_list_t *ll_mapped_to_list(mapped_list_t *ml) {
+	// Lock the mapped list so the copy is consistent.
+	pthread_mutex_lock((pthread_mutex_t *)ml->lock);
+
+	ml_header_t *header = ml_header(ml);
+	size_t n = header->size;
+	void **items = malloc((n > 0 ? n : 1) * sizeof(void *));
+	size_t i = 0;
+
+	// Copy each element into its own allocation.
+	uint64_t offset = header->head;
+	while (items != NULL && offset != ML_NIL) {
+		items[i] = malloc(header->element_size);
+
+		if (items[i] == NULL) {
+			break;
+		}
+
+		memcpy(items[i++], ml_element(ml, offset), header->element_size);
+		offset = ml_node(ml, offset)->next;
+	}
+
+	// Unlock the mapped list.
+	pthread_mutex_unlock((pthread_mutex_t *)ml->lock);
+
+	if (items == NULL) {
+		return NULL;
+	}
+
+	// Build the list in one go if every element was copied.
+	linked_list_t *ll = (i == n) ? ll_from_array(items, n) : NULL;
+
+	// On failure the copies are still ours to free.
+	if (ll == NULL) {
+		while (i > 0) {
+			free(items[--i]);
+		}
+	}
+
+	free(items);
+
+	// Return linked list management node.
+	return ll;
+}
+
+/* Writes the list to a stream, head first, copying element_size bytes from each data pointer.
+ * The list is read in one locked pass and the stream is written after the lock is released. */
+bool ll_export(linked_list_t *ll, FILE *stream, size_t element_size) {
+	// Take a snapshot of the data pointers.
+	void **items = NULL;
+	size_t n = 0;
+
+	if (!ll_snapshot(ll, &items, &n)) {
+		return false;
+	}
+
+	// Describe what follows.
+	ll_stream_header_t header;
+	memcpy(header.magic, ll_stream_magic, sizeof(ll_stream_magic));
+	header.element_size = element_size;
+	header.count = n;
+
+	bool written = fwrite(&header, sizeof(header), 1, stream) == 1;
+
+	// Write each element in list order.
+	size_t i;
+	for (i = 0; written && i < n; i++) {
+		written = fwrite(items[i], element_size, 1, stream) == 1;
+	}
+
+	free(items);
+
+	return written;
+}
+
+/* Reads a list written by ll_export. Each element is copied into its own allocation, owned by the list,
+ * and all nodes share one block as with ll_from_array. Returns NULL if the stream is not a valid export. */
+linked_list_t *ll_import(FILE *stream) {
+	ll_stream_header_t header;
+
+	// Make sure the stream is an exported list.
+	if (fread(&header, sizeof(header), 1, stream) != 1
+			|| memcmp(header.magic, ll_stream_magic, sizeof(ll_stream_magic)) != 0
+			|| header.element_size == 0
+			|| header.count > SIZE_MAX / sizeof(void *)) {
+		return NULL;
+	}
+
+	void **items = malloc((header.count > 0 ? header.count : 1) * sizeof(void *));
+
+	if (items == NULL) {
+		return NULL;
+	}
+
+	// Read each element into its own allocation.
+	size_t i;
+	for (i = 0; i < header.count; i++) {
+		items[i] = malloc(header.element_size);
+
+		if (items[i] == NULL || fread(items[i], header.element_size, 1, stream) != 1) {
+			// Give back everything read so far.
+			free(items[i]);
+			while (i > 0) {
+				free(items[--i]);
+			}
+			free(items);
+
+			return NULL;
+		}
+	}
+
+	// Build the list in one go.
+	linked_list_t *ll = ll_from_array(items, header.count);
+
+	// On failure the elements are still ours to free.
+	if (ll == NULL) {
+		for (i = 0; i < header.count; i++) {
+			free(items[i]);
+		}
+	}
+
+	free(items);
+
+	// Return linked list management node.
+	return ll;
+}
@@ -0,0 +1,34 @@
+#ifndef __MAPPED_LIST_H__
+#define __MAPPED_LIST_H__
+
+#include "linked_list.h"
+
+/* A list of fixed-size elements stored in a memory-mapped file. Nodes link by byte
+ * offset into the file instead of by pointer, so the file can be mapped back in and
+ * used straight away after a restart. */
+typedef struct mapped_list {
+	void *base;
+	size_t length;
+	int fd;
+	void *lock;
+} mapped_list_t;
+
+mapped_list_t *ll_open_mapped(const char *path, size_t element_size);
+bool ll_mapped_checkpoint(mapped_list_t *ml);
+void ll_mapped_close(mapped_list_t *ml);
+size_t ll_mapped_size(mapped_list_t *ml);
+size_t ll_mapped_element_size(mapped_list_t *ml);
+bool ll_mapped_push_tail(mapped_list_t *ml, const void *element);
+bool ll_mapped_push_head(mapped_list_t *ml, const void *element);
+bool ll_mapped_pop_head(mapped_list_t *ml, void *element);
+bool ll_mapped_pop_tail(mapped_list_t *ml, void *element);
+bool ll_mapped_peek_head(mapped_list_t *ml, void *element);
+bool ll_mapped_peek_tail(mapped_list_t *ml, void *element);
+bool ll_mapped_find(mapped_list_t *ml, void *element, bool (*compare_function)(void *cmd_data));
+bool ll_mapped_pop_by(mapped_list_t *ml, void *element, bool (*compare_function)(void *cmd_data));
+linked_list_t *ll_mapped_to_list(mapped_list_t *ml);
+
+bool ll_export(linked_list_t *ll, FILE *stream, size_t element_size);
+linked_list_t *ll_import(FILE *stream);
+
+#endif //__MAPPED_LIST_H__